@@ -0,0 +1,201 @@
+#include "BidirectionalSolver.hpp"
+
+#include <array>
+#include <bit>
+#include <optional>
+#include <utility>
+
+static constexpr uint8_t EMPTY = 0xFF;
+static constexpr uint8_t NO_FACE = 6;
+
+// an open addressing hash set of packed states and the depths they were first reached at, at most half full
+struct StateSet
+{
+    struct Entry
+    {
+        StateRank::Key Key;
+        uint8_t Depth;
+    };
+
+    std::vector<Entry> Entries = std::vector<Entry>(1024, Entry { { }, EMPTY });
+    size_t Size = 0;
+
+    auto GetSlot(const StateRank::Key& key) const -> size_t
+    {
+        // the low bits of a rank are its edge flips, the hash is spread over the whole table
+        uint64_t hash = StateRank::KeyHash()(key) * 0x9E3779B97F4A7C15ull;
+        size_t slot = hash >> (64 - std::countr_zero(Entries.size()));
+        while (Entries[slot].Depth != EMPTY && Entries[slot].Key != key)
+            slot = (slot + 1) & (Entries.size() - 1);
+
+        return slot;
+    }
+    auto Find(const StateRank::Key& key) const -> std::optional<uint8_t>
+    {
+        const Entry& entry = Entries[GetSlot(key)];
+        return entry.Depth == EMPTY ? std::nullopt : std::optional<uint8_t>(entry.Depth);
+    }
+    // false if the state was there already
+    auto Insert(const StateRank::Key& key, uint8_t depth) -> bool
+    {
+        Entry& entry = Entries[GetSlot(key)];
+        if (entry.Depth != EMPTY)
+            return false;
+
+        entry = { key, depth };
+        Size++;
+        return true;
+    }
+
+    inline auto IsFull() const -> bool { return (Size + 1) * 2 > Entries.size(); }
+    inline auto GetBytes() const -> size_t { return Entries.size() * sizeof(Entry); }
+    auto Grow() -> void
+    {
+        std::vector<Entry> entries(Entries.size() * 2, Entry { { }, EMPTY });
+        std::swap(entries, Entries);
+        for (const Entry& entry : entries)
+        {
+            if (entry.Depth != EMPTY)
+                Entries[GetSlot(entry.Key)] = entry;
+        }
+    }
+};
+
+// one of the two searches: the states seen so far, and the deepest ones with the face they were reached by
+struct SearchSide
+{
+    struct Node
+    {
+        StateRank::Key Key;
+        uint8_t LastFace;
+    };
+
+    StateSet States;
+    std::vector<Node> Frontier;
+    uint32_t Depth = 0;
+};
+
+// the moves taking the root of the set to the cube, every shortest sequence or the first one found
+static auto GetPaths(const StateSet& states, const CubieCube& cube, uint32_t depth, bool all) -> std::vector<std::vector<uint32_t>>
+{
+    if (depth == 0)
+        return { { } };
+
+    std::vector<std::vector<uint32_t>> paths;
+    for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+    {
+        CubieCube previous = cube;
+        previous.ApplyMove(move / 3 * 3 + 2 - move % 3);
+
+        std::optional<uint8_t> previousDepth = states.Find(StateRank::Rank3x3(previous));
+        if (!previousDepth.has_value() || previousDepth.value() != depth - 1)
+            continue;
+
+        for (std::vector<uint32_t>& path : GetPaths(states, previous, depth - 1, all))
+        {
+            path.push_back(move);
+            paths.push_back(std::move(path));
+            if (!all)
+                return paths;
+        }
+    }
+
+    return paths;
+}
+
+auto BidirectionalSolver::Solve(const CubieCube& from, const CubieCube& to, uint32_t maxLength, size_t memoryBudget, bool allSolutions)
+    -> Result
+{
+    Result result = { .Solutions = { }, .Length = 0, .StatesStored = 0, .OutOfMemory = false };
+    if (from == to)
+    {
+        result.Solutions.push_back({ });
+        return result;
+    }
+
+    std::array<SearchSide, 2> sides;
+    for (uint32_t s = 0; s < 2; s++)
+    {
+        StateRank::Key key = StateRank::Rank3x3(s == 0 ? from : to);
+        sides[s].States.Insert(key, 0);
+        sides[s].Frontier.push_back({ key, NO_FACE });
+    }
+
+    std::vector<CubieCube> meetings;
+    while (meetings.empty() && sides[0].Depth + sides[1].Depth < maxLength)
+    {
+        uint32_t s = sides[0].Frontier.size() <= sides[1].Frontier.size() ? 0 : 1;
+        SearchSide& side = sides[s];
+        const SearchSide& other = sides[1 - s];
+
+        std::vector<SearchSide::Node> next;
+        for (const SearchSide::Node& node : side.Frontier)
+        {
+            CubieCube cube = StateRank::Unrank3x3(node.Key);
+            for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+            {
+                // the same face twice is one move, and of two commuting opposite faces only one order is taken
+                uint8_t face = move / 3;
+                if (node.LastFace != NO_FACE && (face == node.LastFace || (face == (node.LastFace + 3) % 6 && face < node.LastFace)))
+                    continue;
+
+                if (side.States.IsFull())
+                {
+                    size_t frontierBytes = (side.Frontier.size() + next.size()) * sizeof(SearchSide::Node);
+                    if (side.States.GetBytes() * 3 + other.States.GetBytes() + frontierBytes > memoryBudget)
+                    {
+                        result.Length = sides[0].Depth + sides[1].Depth;
+                        result.StatesStored = sides[0].States.Size + sides[1].States.Size;
+                        result.OutOfMemory = true;
+                        return result;
+                    }
+
+                    side.States.Grow();
+                }
+
+                CubieCube turned = cube;
+                turned.ApplyMove(move);
+                StateRank::Key key = StateRank::Rank3x3(turned);
+                if (!side.States.Insert(key, side.Depth + 1))
+                    continue;
+
+                // every state met here ends shortest paths, the other side's depths are never smaller
+                if (other.States.Find(key).has_value())
+                {
+                    meetings.push_back(turned);
+                    if (!allSolutions)
+                        break;
+                }
+
+                next.push_back({ key, face });
+            }
+
+            if (!meetings.empty() && !allSolutions)
+                break;
+        }
+
+        side.Depth++;
+        side.Frontier = std::move(next);
+    }
+
+    result.Length = sides[0].Depth + sides[1].Depth;
+    result.StatesStored = sides[0].States.Size + sides[1].States.Size;
+    for (const CubieCube& meeting : meetings)
+    {
+        // the second half is the path from to, undone
+        std::vector<std::vector<uint32_t>> backwardPaths = GetPaths(sides[1].States, meeting, sides[1].Depth, allSolutions);
+        for (const std::vector<uint32_t>& forwardPath : GetPaths(sides[0].States, meeting, sides[0].Depth, allSolutions))
+        {
+            for (const std::vector<uint32_t>& backwardPath : backwardPaths)
+            {
+                std::vector<uint32_t> solution = forwardPath;
+                for (auto it = backwardPath.rbegin(); it != backwardPath.rend(); it++)
+                    solution.push_back(*it / 3 * 3 + 2 - *it % 3);
+
+                result.Solutions.push_back(std::move(solution));
+            }
+        }
+    }
+
+    return result;
+}
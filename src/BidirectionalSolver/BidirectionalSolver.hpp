@@ -0,0 +1,38 @@
+#ifndef BIDIRECTIONALSOLVER_H
+#define BIDIRECTIONALSOLVER_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "StateRank/StateRank.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Shortest 3x3 move sequences between two nearby states, meeting in the middle: breadth first frontiers grow
+// from both states, always the smaller one, into open addressing hash sets of the packed states (StateRank)
+// and their depths. A state of one frontier found in the other side's set ends every shortest path through it,
+// and the paths are read back from the depths. Two 6 move halves store about 8 million states a side, so the
+// memory budget bounds how far apart the states may be.
+class BidirectionalSolver
+{
+public:
+    static constexpr uint32_t MAX_LENGTH = 14;
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = size_t(1) << 30;
+
+    struct Result
+    {
+        // the shortest move sequences taking from to to, all of them when asked for; empty if none was found
+        std::vector<std::vector<uint32_t>> Solutions;
+        // the length of the solutions, or the length ruled out when none was found
+        uint32_t Length;
+        uint64_t StatesStored;
+        // the search stopped before the maximum length, its sets would have outgrown the budget
+        bool OutOfMemory;
+    };
+
+public:
+    static auto Solve(const CubieCube& from, const CubieCube& to, uint32_t maxLength = MAX_LENGTH,
+        size_t memoryBudget = DEFAULT_MEMORY_BUDGET, bool allSolutions = false) -> Result;
+};
+
+#endif
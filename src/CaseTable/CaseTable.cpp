@@ -0,0 +1,24 @@
+#include "CaseTable.hpp"
+
+CaseTable::CaseTable(std::span<const Algorithm> algorithms)
+    : m_DescriptorCount(algorithms.empty() ? 0 : algorithms.front().Pattern.GetDescriptorCount())
+{
+    m_Cases.reserve(algorithms.size() * 4);
+    for (const Algorithm& algorithm : algorithms)
+    {
+        for (uint32_t rotation = 0; rotation < 4; rotation++)
+            m_Cases.try_emplace(algorithm.Pattern.GetKey(rotation), Case { &algorithm, rotation });
+    }
+}
+
+auto CaseTable::Find(const ColorPattern& pattern) const -> std::optional<Case>
+{
+    if (pattern.GetDescriptorCount() != m_DescriptorCount)
+        return std::nullopt;
+
+    auto it = m_Cases.find(pattern.GetKey());
+    if (it == m_Cases.end())
+        return std::nullopt;
+
+    return it->second;
+}
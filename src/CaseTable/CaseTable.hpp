@@ -0,0 +1,36 @@
+#ifndef CASETABLE_H
+#define CASETABLE_H
+
+#include "Algorithm/Algorithm.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+// Every rotation of every algorithm's pattern, keyed by its packed descriptors, so recognizing the case
+// of a layer is a single lookup instead of a scan over all the algorithms.
+class CaseTable
+{
+public:
+    struct Case
+    {
+        const Algorithm* Match;
+        // the U' turns aligning the layer with the pattern
+        uint32_t Rotation;
+    };
+
+public:
+    // the algorithms must outlive the table, earlier ones win when their patterns collide
+    explicit CaseTable(std::span<const Algorithm> algorithms);
+
+    auto Find(const ColorPattern& pattern) const -> std::optional<Case>;
+
+    inline auto GetSize() const -> size_t { return m_Cases.size(); }
+
+private:
+    uint32_t m_DescriptorCount;
+    std::unordered_map<uint64_t, Case> m_Cases;
+};
+
+#endif
@@ -1,31 +1,37 @@
 #include "ColorPattern.hpp"
 
 
+ColorPattern::ColorPattern(const std::vector<ColorDescriptor>& colors)
+    : ColorPattern(static_cast<uint32_t>(colors.size() / 4))
+{
+    for (ColorDescriptor color : colors)
+        _Append(color);
+}
+
 ColorPattern::ColorPattern(const std::string& colors)
+    : ColorPattern(static_cast<uint32_t>(colors.size() / 4))
 {
-    m_CubeSize = static_cast<uint32_t>(colors.size() / 4);
-    m_Colors.reserve(colors.size());
     for (const char& color : colors)
     {
         switch (color)
         {
         case 'D':
-            m_Colors.push_back(ColorDescriptor::DONT_CARE);
+            _Append(ColorDescriptor::DONT_CARE);
             break;
         case 'B':
-            m_Colors.push_back(ColorDescriptor::BASE_COLOR);
+            _Append(ColorDescriptor::BASE_COLOR);
             break;
         case 'S':
-            m_Colors.push_back(ColorDescriptor::SAME);
+            _Append(ColorDescriptor::SAME);
             break;
         case 'L':
-            m_Colors.push_back(ColorDescriptor::LEFT_NEIGHBOR);
+            _Append(ColorDescriptor::LEFT_NEIGHBOR);
             break;
         case 'R':
-            m_Colors.push_back(ColorDescriptor::RIGHT_NEIGHBOR);
+            _Append(ColorDescriptor::RIGHT_NEIGHBOR);
             break;
         case 'O':
-            m_Colors.push_back(ColorDescriptor::OPPOSITE);
+            _Append(ColorDescriptor::OPPOSITE);
             break;
         }
     }
@@ -33,26 +39,13 @@ ColorPattern::ColorPattern(const std::string& colors)
 
 auto ColorPattern::Match(const ColorPattern& other) const -> uint32_t
 {
-    if (m_CubeSize != other.GetCubeSize())
+    if (m_CubeSize != other.GetCubeSize() || m_DescriptorCount != other.GetDescriptorCount())
         return 5;
 
-    // check of the patterns match in any of the 4 rotations
-    bool match;
-    int idx;
+    // return how many rotations are needed to match the pattern
     for (uint32_t i = 0; i < 4; i++)
     {
-        match = true;
-        for (uint32_t j = 0; j < m_Colors.size(); j++)
-        {
-            idx = (m_CubeSize * i + j) % m_Colors.size();
-            if (m_Colors[j] != other.GetColors()[idx])
-            {
-                match = false;
-                break;
-            }
-        }
-        // return how many rotations are needed to match the pattern
-        if (match)
+        if (m_Key == other.GetKey(i))
             return i;
     }
 
@@ -60,39 +53,57 @@ auto ColorPattern::Match(const ColorPattern& other) const -> uint32_t
     return 5;
 }
 
+auto ColorPattern::GetKey(uint32_t rotation) const -> uint64_t
+{
+    uint32_t bits = m_DescriptorCount * DESCRIPTOR_BITS;
+    uint32_t shift = (rotation % 4) * m_CubeSize * DESCRIPTOR_BITS;
+    if (shift == 0 || shift >= bits)
+        return m_Key;
+
+    uint64_t mask = bits == 64 ? ~0ull : (1ull << bits) - 1;
+    return ((m_Key >> shift) | (m_Key << (bits - shift))) & mask;
+}
+
+auto ColorPattern::_Append(ColorDescriptor descriptor) -> void
+{
+    if (m_DescriptorCount == MAX_DESCRIPTORS)
+        return;
+
+    m_Key |= static_cast<uint64_t>(descriptor) << (m_DescriptorCount * DESCRIPTOR_BITS);
+    m_DescriptorCount++;
+}
+
 auto ColorPattern::CreateOLLPatternFromTopLayer(const Cube& cube, FaceColor OLLColor) -> ColorPattern
 {
-    std::vector<ColorDescriptor> colors;
     uint32_t size = cube.GetSize();
-    colors.reserve(size * 4);
+    ColorPattern pattern(size);
 
     // front face
     for (uint32_t i = 0; i < size; i++)
-        colors.push_back(cube.GetPieceColors({ i, size - 1, size - 1 }).value().get()[Face::Front] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
+        pattern._Append(cube.GetPieceColors({ i, size - 1, size - 1 }).value().get()[Face::Front] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
 
     // right face
     for (uint32_t i = 0; i < size; i++)
-        colors.push_back(cube.GetPieceColors({ size - 1, size - 1, size - 1 - i }).value().get()[Face::Right] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
+        pattern._Append(cube.GetPieceColors({ size - 1, size - 1, size - 1 - i }).value().get()[Face::Right] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
 
     // back face
     for (uint32_t i = 0; i < size; i++)
-        colors.push_back(cube.GetPieceColors({ size - 1 - i, size - 1, 0 }).value().get()[Face::Back] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
+        pattern._Append(cube.GetPieceColors({ size - 1 - i, size - 1, 0 }).value().get()[Face::Back] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
 
     // left face
     for (uint32_t i = 0; i < size; i++)
-        colors.push_back(cube.GetPieceColors({ 0, size - 1, i }).value().get()[Face::Left] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
+        pattern._Append(cube.GetPieceColors({ 0, size - 1, i }).value().get()[Face::Left] == OLLColor ? ColorDescriptor::BASE_COLOR : ColorDescriptor::DONT_CARE);
 
-    return ColorPattern{ colors };
+    return pattern;
 }
 
 auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPattern
 {
-    std::vector<ColorDescriptor> colors;
     uint32_t size = cube.GetSize();
-    colors.reserve(size * 4);
+    ColorPattern pattern(size);
 
     // front face
-    colors.push_back(
+    pattern._Append(
         CreateDescriptorFromTwoColors(
             cube.GetPieceColors({ 0, size - 1, size - 1 }).value().get()[Face::Left],
             cube.GetPieceColors({ 0, size - 1, size - 1 }).value().get()[Face::Front]
@@ -100,7 +111,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     );
     for (uint32_t i = 1; i < size; i++)
     {
-        colors.push_back(
+        pattern._Append(
             CreateDescriptorFromTwoColors(
                 cube.GetPieceColors({ i - 1, size - 1, size - 1 }).value().get()[Face::Front],
                 cube.GetPieceColors({ i    , size - 1, size - 1 }).value().get()[Face::Front]
@@ -109,7 +120,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     }
 
     // right face
-    colors.push_back(
+    pattern._Append(
         CreateDescriptorFromTwoColors(
             cube.GetPieceColors({ size - 1, size - 1, size - 1 }).value().get()[Face::Front],
             cube.GetPieceColors({ size - 1, size - 1, size - 1 }).value().get()[Face::Right]
@@ -117,7 +128,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     );
     for (uint32_t i = 1; i < size; i++)
     {
-        colors.push_back(
+        pattern._Append(
             CreateDescriptorFromTwoColors(
                 cube.GetPieceColors({ size - 1, size - 1, size - 1 - i + 1 }).value().get()[Face::Right],
                 cube.GetPieceColors({ size - 1, size - 1, size - 1 - i     }).value().get()[Face::Right]
@@ -126,7 +137,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     }
 
     // back face
-    colors.push_back(
+    pattern._Append(
         CreateDescriptorFromTwoColors(
             cube.GetPieceColors({ size - 1, size - 1, 0 }).value().get()[Face::Right],
             cube.GetPieceColors({ size - 1, size - 1, 0 }).value().get()[Face::Back]
@@ -134,7 +145,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     );
     for (uint32_t i = 1; i < size; i++)
     {
-        colors.push_back(
+        pattern._Append(
             CreateDescriptorFromTwoColors(
                 cube.GetPieceColors({ size - 1 - i + 1, size - 1, 0 }).value().get()[Face::Back],
                 cube.GetPieceColors({ size - 1 - i    , size - 1, 0 }).value().get()[Face::Back]
@@ -143,7 +154,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     }
 
     // left face
-    colors.push_back(
+    pattern._Append(
         CreateDescriptorFromTwoColors(
             cube.GetPieceColors({ 0, size - 1, 0 }).value().get()[Face::Back],
             cube.GetPieceColors({ 0, size - 1, 0 }).value().get()[Face::Left]
@@ -151,7 +162,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
     );
     for (uint32_t i = 1; i < size; i++)
     {
-        colors.push_back(
+        pattern._Append(
             CreateDescriptorFromTwoColors(
                 cube.GetPieceColors({ 0, size - 1, i - 1 }).value().get()[Face::Left],
                 cube.GetPieceColors({ 0, size - 1, i     }).value().get()[Face::Left]
@@ -159,7 +170,7 @@ auto ColorPattern::CreatePLLPatternFromTopLayer(const Cube& cube) -> ColorPatter
         );
     }
 
-    return ColorPattern{ colors };
+    return pattern;
 }
 
 auto ColorPattern::CreateDescriptorFromTwoColors(FaceColor left, FaceColor right) -> ColorDescriptor
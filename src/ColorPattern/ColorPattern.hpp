@@ -4,9 +4,12 @@
 #include "Cube/Cube.hpp"
 #include "Face/FaceColor.hpp"
 
+#include <cstdint>
+#include <string>
 #include <vector>
-#include <memory>
 
+// The descriptors of the stickers around the top layer, packed into an integer with 3 bits per descriptor
+// (up to 21 of them), so patterns compare and hash as plain keys.
 class ColorPattern
 {
 public:
@@ -23,16 +26,24 @@ public:
         OPPOSITE
     };
 
-public:
-    explicit ColorPattern(const std::vector<ColorDescriptor>& colors)
-        : m_CubeSize(static_cast<uint32_t>(colors.size() / 4)), m_Colors(colors) { }
+    static constexpr uint32_t DESCRIPTOR_BITS = 3;
+    static constexpr uint32_t MAX_DESCRIPTORS = 64 / DESCRIPTOR_BITS;
 
+public:
+    explicit ColorPattern(const std::vector<ColorDescriptor>& colors);
     explicit ColorPattern(const std::string& colors);
 
     auto Match(const ColorPattern& other) const -> uint32_t;
 
     inline auto GetCubeSize() const -> uint32_t { return m_CubeSize; }
-    inline auto GetColors() const -> const std::vector<ColorDescriptor>& { return m_Colors; }
+    inline auto GetDescriptorCount() const -> uint32_t { return m_DescriptorCount; }
+    inline auto GetDescriptor(uint32_t index) const -> ColorDescriptor
+    {
+        return static_cast<ColorDescriptor>((m_Key >> (index * DESCRIPTOR_BITS)) & ((1u << DESCRIPTOR_BITS) - 1));
+    }
+
+    // the pattern turned by rotation quarter turns, as seen after that many U turns of the layer
+    auto GetKey(uint32_t rotation = 0) const -> uint64_t;
 
 public:
     static auto CreateOLLPatternFromTopLayer(const Cube& cube, FaceColor OLLColor) -> ColorPattern;
@@ -40,9 +51,16 @@ public:
 
     static auto CreateDescriptorFromTwoColors(FaceColor left, FaceColor right) -> ColorDescriptor;
 
+private:
+    explicit ColorPattern(uint32_t cubeSize)
+        : m_CubeSize(cubeSize), m_DescriptorCount(0), m_Key(0) { }
+
+    auto _Append(ColorDescriptor descriptor) -> void;
+
 private:
     uint32_t m_CubeSize;
-    std::vector<ColorDescriptor> m_Colors;
+    uint32_t m_DescriptorCount;
+    uint64_t m_Key;
 };
 
 #endif
\ No newline at end of file
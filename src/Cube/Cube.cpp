@@ -6,7 +6,8 @@
 #include <string>
 
 Cube::Cube(uint32_t layers, const Vector3& position, float size)
-    : m_Layers(layers), m_Position(position), m_Size(size), m_Animations(true), m_AnimationSpeed(10.0f)
+    : m_Layers(layers), m_Position(position), m_Size(size), m_Animations(true), m_AnimationSpeed(10.0f),
+      m_DeferredTurns(true), m_AppliedColorTurns(0), m_AppliedPieceTurns(0), m_Pristine(false), m_SizePoolClock(0)
 {
     Reset();
 }
@@ -598,96 +599,56 @@ auto Cube::IsSolved() const -> bool
     return true;
 }
 
-auto Cube::Reset() -> void
+auto Cube::SetSize(uint32_t size) -> void
 {
-    // empty the move queue
-    while (!m_Rotations.empty())
-        m_Rotations.pop();
-
-    // calculate helper variables
-    float pieceSize = m_Size / static_cast<float>(m_Layers);
-    Vector3 cornerPosition = m_Position - Vector3 { 
-        m_Size * 0.5f - pieceSize * 0.5f, 
-        m_Size * 0.5f - pieceSize * 0.5f,
-        m_Size * 0.5f - pieceSize * 0.5f
-    };
-
-    // create the pieces and the piece colors
-    m_Pieces.clear();
-    m_Pieces.reserve(m_Layers * m_Layers * m_Layers);
-    m_CurrentPieceColors.clear();
-    m_CurrentPieceColors.reserve(m_Layers * m_Layers * m_Layers);
-    for (uint32_t z = 0; z < m_Layers; z++)
+    if (size != m_Layers)
     {
-        for (uint32_t y = 0; y < m_Layers; y++)
+        // the buffers of a solved cube are kept as they are, so coming back to this size just swaps them in
+        if (m_Pristine)
         {
-            for (uint32_t x = 0; x < m_Layers; x++)
-            {
-                m_Pieces.emplace_back(
-                    cornerPosition + Vector3(x, y, z) * pieceSize, 
-                    pieceSize * STICKER_SCALE
-                );
-                m_CurrentPieceColors.emplace_back(std::array<FaceColor, 6>{
-                    FaceColor::None, 
-                    FaceColor::None, 
-                    FaceColor::None,
-                    FaceColor::None,
-                    FaceColor::None,
-                    FaceColor::None
-                });
-            }
+            SizePoolEntry& entry = m_SizePool[m_Layers];
+            entry.StashedPieceColors.swap(m_CurrentPieceColors);
+            entry.StashedPieces.swap(m_Pieces);
         }
-    }
 
-    // set the face colors of the pieces
-    for (uint32_t z = 0; z < m_Layers; z++)
-    {
-        for (uint32_t y = 0; y < m_Layers; y++)
-        {
-            for (uint32_t x = 0; x < m_Layers; x++)
-            {
-                PieceColors& pieceColors = GetPieceColors({ x, y, z }).value().get();
-                Piece& piece = _GetPiece({ x, y, z }).value().get();
-                if (x == 0)
-                {
-                    pieceColors[Face::Left] = FaceColor::Orange;
-                    piece.SetFaceColor(Face::Left, FaceColor::Orange);
-                }
-                if (x == m_Layers - 1)
-                {
-                    pieceColors[Face::Right] = FaceColor::Red;
-                    piece.SetFaceColor(Face::Right, FaceColor::Red);
-                }
-                if (y == 0)
-                {
-                    pieceColors[Face::Bottom] = FaceColor::Yellow;
-                    piece.SetFaceColor(Face::Bottom, FaceColor::Yellow);
-                }
-                if (y == m_Layers - 1)
-                {
-                    pieceColors[Face::Top] = FaceColor::White;
-                    piece.SetFaceColor(Face::Top, FaceColor::White);
-                }
-                if (z == 0)
-                {
-                    pieceColors[Face::Back] = FaceColor::Blue;
-                    piece.SetFaceColor(Face::Back, FaceColor::Blue);
-                }
-                if (z == m_Layers - 1)
-                {
-                    pieceColors[Face::Front] = FaceColor::Green;
-                    piece.SetFaceColor(Face::Front, FaceColor::Green);
-                }
-            }
-        }
+        m_Layers = size;
+        m_Pristine = false;
     }
 
+    Reset();
+}
+auto Cube::Reset() -> void
+{
+    // empty the move queue and drop the deferred turns
+    while (!m_Rotations.empty())
+        m_Rotations.pop();
+
+    m_TurnLog.clear();
+    m_AppliedColorTurns = 0;
+    m_AppliedPieceTurns = 0;
+
     // initialize the rotation matrix
     m_RotationMatrix = MatrixIdentity();
+
+    if (!m_Pristine)
+        _LoadSolvedBuffers();
+}
+
+auto Cube::LoadPieceColors(const std::vector<PieceColors>& pieceColors) -> void
+{
+    if (pieceColors.size() != m_CurrentPieceColors.size())
+        return;
+
+    Reset();
+    m_Pristine = false;
+    m_CurrentPieceColors = pieceColors;
+    _RebuildPiecesFromColors();
 }
 
 auto Cube::Update(float deltaTime) -> void
 {
+    _ApplyAllDeferredTurns();
+
     if (m_Rotations.empty())
         return;
 
@@ -711,6 +672,8 @@ auto Cube::Update(float deltaTime) -> void
 }
 auto Cube::Draw() const -> void
 {
+    _ApplyAllDeferredTurns();
+
     rlPushMatrix();
     rlMultMatrixf(MatrixToFloat(m_RotationMatrix));
 
@@ -722,6 +685,17 @@ auto Cube::Draw() const -> void
 
 auto Cube::MakeTurn(const Turn& turn) -> void
 {
+    m_Pristine = false;
+    if (m_RecordedTurns.has_value())
+        m_RecordedTurns->push_back(turn);
+
+    if (_IsDeferringTurns())
+    {
+        m_TurnLog.push_back(turn);
+        return;
+    }
+    _ApplyAllDeferredTurns();
+
     auto indices = _GetIndicesByTurn(turn);
     auto indicesInversed = _GetIndicesByTurnInversed(turn);
 
@@ -735,6 +709,35 @@ auto Cube::MakeTurn(const Turn& turn) -> void
 }
 auto Cube::MakeMultiLayerTurn(const std::vector<Turn>& turns) -> void
 {
+    m_Pristine = false;
+    if (m_RecordedTurns.has_value())
+        m_RecordedTurns->insert(m_RecordedTurns->end(), turns.begin(), turns.end());
+
+    if (_IsDeferringTurns())
+    {
+        m_TurnLog.insert(m_TurnLog.end(), turns.begin(), turns.end());
+        return;
+    }
+    _ApplyAllDeferredTurns();
+
+    // distinct layers of one axis (wide moves, x, y, z) are turned in a single sweep
+    std::vector<uint8_t> quarterTurns(m_Layers);
+    bool singleAxis = !turns.empty();
+    for (const auto& turn : turns)
+    {
+        singleAxis &= turn.LayerType == turns.front().LayerType && turn.LayerIndex < m_Layers && quarterTurns[turn.LayerIndex] == 0;
+        if (!singleAxis)
+            break;
+
+        quarterTurns[turn.LayerIndex] = turn.Clockwise ? 1 : 3;
+    }
+    if (singleAxis)
+    {
+        _ApplyAxisTurns(turns.front().LayerType, quarterTurns, true, false);
+        m_Rotations.emplace(*this, turns);
+        return;
+    }
+
     for (const auto& turn : turns)
     {
         auto indices = _GetIndicesByTurn(turn);
@@ -819,6 +822,285 @@ auto Cube::_MakeBigMove(std::string_view move) -> void
     MakeMultiLayerTurn(turns);
 }
 
+auto Cube::_LoadSolvedBuffers() -> void
+{
+    SizePoolEntry& entry = m_SizePool[m_Layers];
+    entry.LastUse = ++m_SizePoolClock;
+
+    if (!entry.StashedPieces.empty())
+    {
+        m_CurrentPieceColors.swap(entry.StashedPieceColors);
+        m_Pieces.swap(entry.StashedPieces);
+
+        // what was swapped out belongs to another state, so it is released
+        std::vector<PieceColors>().swap(entry.StashedPieceColors);
+        std::vector<Piece>().swap(entry.StashedPieces);
+    }
+    else if (!entry.TemplatePieces.empty())
+    {
+        // plain copies into the already allocated buffers
+        m_CurrentPieceColors.assign(entry.TemplatePieceColors.begin(), entry.TemplatePieceColors.end());
+        m_Pieces.assign(entry.TemplatePieces.begin(), entry.TemplatePieces.end());
+    }
+    else
+    {
+        _BuildSolvedBuffers();
+        entry.TemplatePieceColors = m_CurrentPieceColors;
+        entry.TemplatePieces = m_Pieces;
+    }
+
+    m_Pristine = true;
+    _TrimSizePool();
+}
+auto Cube::_BuildSolvedBuffers() -> void
+{
+    // set the face colors of the pieces, then build the pieces showing them
+    m_CurrentPieceColors.assign(m_Layers * m_Layers * m_Layers, PieceColors { });
+    _ParallelFor(m_Layers, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t z = begin; z < end; z++)
+        {
+            for (uint32_t y = 0; y < m_Layers; y++)
+            {
+                for (uint32_t x = 0; x < m_Layers; x++)
+                {
+                    PieceColors& pieceColors = m_CurrentPieceColors[z * m_Layers * m_Layers + y * m_Layers + x];
+                    if (x == 0)
+                        pieceColors[Face::Left] = FaceColor::Orange;
+                    if (x == m_Layers - 1)
+                        pieceColors[Face::Right] = FaceColor::Red;
+                    if (y == 0)
+                        pieceColors[Face::Bottom] = FaceColor::Yellow;
+                    if (y == m_Layers - 1)
+                        pieceColors[Face::Top] = FaceColor::White;
+                    if (z == 0)
+                        pieceColors[Face::Back] = FaceColor::Blue;
+                    if (z == m_Layers - 1)
+                        pieceColors[Face::Front] = FaceColor::Green;
+                }
+            }
+        }
+    });
+    _RebuildPiecesFromColors();
+}
+auto Cube::_TrimSizePool() -> void
+{
+    size_t memoryUsage = 0;
+    for (const auto& [size, entry] : m_SizePool)
+        memoryUsage += entry.GetMemoryUsage();
+
+    // evict the least recently used sizes, but never the current one
+    while (memoryUsage > SIZE_POOL_MEMORY_LIMIT)
+    {
+        auto oldest = m_SizePool.end();
+        for (auto it = m_SizePool.begin(); it != m_SizePool.end(); it++)
+            if (it->first != m_Layers && (oldest == m_SizePool.end() || it->second.LastUse < oldest->second.LastUse))
+                oldest = it;
+
+        if (oldest == m_SizePool.end())
+            break;
+
+        memoryUsage -= oldest->second.GetMemoryUsage();
+        m_SizePool.erase(oldest);
+    }
+}
+
+auto Cube::SizePoolEntry::GetMemoryUsage() const -> size_t
+{
+    return (TemplatePieceColors.capacity() + StashedPieceColors.capacity()) * sizeof(PieceColors) +
+        (TemplatePieces.capacity() + StashedPieces.capacity()) * sizeof(Piece);
+}
+
+auto Cube::_ApplyDeferredTurns(bool colors, bool pieces) const -> void
+{
+    // with a long backlog it is cheaper to rebuild every piece from the up to date colors
+    if (pieces && (m_TurnLog.size() - m_AppliedPieceTurns) * PIECE_REBUILD_FACTOR >= m_Layers)
+    {
+        _ApplyDeferredTurns(true, false);
+        _RebuildPiecesFromColors();
+        m_AppliedPieceTurns = m_TurnLog.size();
+        pieces = false;
+    }
+
+    // the pieces may lag behind the colors, so start from the older of the two
+    size_t start = std::min(
+        colors ? m_AppliedColorTurns : m_TurnLog.size(),
+        pieces ? m_AppliedPieceTurns : m_TurnLog.size()
+    );
+
+    // turns around the same axis commute, so a run of them is coalesced into the net quarter turns of every layer
+    std::vector<uint8_t> quarterTurns(m_Layers);
+    while (start < m_TurnLog.size())
+    {
+        Direction axis = m_TurnLog[start].LayerType;
+        size_t end = start;
+
+        // a run must not straddle the point up to which the colors or the pieces are already applied
+        size_t stop = m_TurnLog.size();
+        for (size_t applied : { m_AppliedColorTurns, m_AppliedPieceTurns })
+            if (applied > start && applied < stop)
+                stop = applied;
+
+        std::ranges::fill(quarterTurns, 0);
+        for (; end < stop && m_TurnLog[end].LayerType == axis; end++)
+        {
+            uint8_t& layerTurns = quarterTurns[m_TurnLog[end].LayerIndex];
+            layerTurns = (layerTurns + (m_TurnLog[end].Clockwise ? 1 : 3)) % 4;
+        }
+
+        _ApplyAxisTurns(
+            axis,
+            quarterTurns,
+            colors && start >= m_AppliedColorTurns,
+            pieces && start >= m_AppliedPieceTurns
+        );
+        start = end;
+    }
+
+    if (colors)
+        m_AppliedColorTurns = m_TurnLog.size();
+    if (pieces)
+        m_AppliedPieceTurns = m_TurnLog.size();
+
+    // forget the log once both the colors and the pieces are up to date
+    if (m_AppliedColorTurns == m_TurnLog.size() && m_AppliedPieceTurns == m_TurnLog.size())
+    {
+        m_TurnLog.clear();
+        m_AppliedColorTurns = 0;
+        m_AppliedPieceTurns = 0;
+    }
+}
+auto Cube::_ApplyAxisTurns(Direction axis, const std::vector<uint8_t>& quarterTurns, bool colors, bool pieces) const -> void
+{
+    const uint32_t last = m_Layers - 1;
+    const uint32_t layerSize = m_Layers * m_Layers;
+
+    // index of the piece at (u, v) in the given layer, where (u, v) is the layer's own 2D coordinate system
+    auto getIndex = [this, axis](uint32_t layer, uint32_t u, uint32_t v) -> uint32_t {
+        switch (axis)
+        {
+        case Direction::Horizontal:
+            return v * m_Layers * m_Layers + layer * m_Layers + u;
+        case Direction::Vertical:
+            return v * m_Layers * m_Layers + u * m_Layers + layer;
+        case Direction::Depthical:
+            return layer * m_Layers * m_Layers + v * m_Layers + u;
+        }
+
+        std::unreachable();
+    };
+
+    // the layers are independent, so large cubes turn them in parallel, each thread with its own copy buffers
+    _ParallelFor(m_Layers, [&](uint32_t begin, uint32_t end) {
+        thread_local std::vector<PieceColors> scratchPieceColors;
+        thread_local std::vector<Piece> scratchPieces;
+
+        scratchPieceColors.resize(colors ? layerSize : 0);
+        if (pieces)
+            scratchPieces.reserve(layerSize);
+
+        for (uint32_t layer = begin; layer < end; layer++)
+        {
+            uint8_t turns = quarterTurns[layer];
+            if (turns == 0)
+                continue;
+
+            // copy out the layer
+            if (pieces)
+                scratchPieces.clear();
+            for (uint32_t v = 0; v < m_Layers; v++)
+            {
+                for (uint32_t u = 0; u < m_Layers; u++)
+                {
+                    uint32_t index = getIndex(layer, u, v);
+                    if (colors)
+                        scratchPieceColors[v * m_Layers + u] = m_CurrentPieceColors[index];
+                    if (pieces)
+                        scratchPieces.push_back(m_Pieces[index]);
+                }
+            }
+
+            // rotate the pieces of the layer in place by the net angle
+            if (pieces)
+            {
+                float angle = turns == 3 ? PI / 2.0f : -static_cast<float>(turns) * PI / 2.0f;
+                Vector3 rotation {
+                    axis == Direction::Vertical ? angle : 0.0f,
+                    axis == Direction::Horizontal ? angle : 0.0f,
+                    axis == Direction::Depthical ? angle : 0.0f
+                };
+                for (auto& piece : scratchPieces)
+                    piece.SetRotation(rotation, true);
+            }
+
+            // write the layer back, each location receiving the piece turned onto it (see _GetIndicesByTurnInversed)
+            auto transition = PieceColors::GetFaceTransition(axis, turns);
+            for (uint32_t v = 0; v < m_Layers; v++)
+            {
+                for (uint32_t u = 0; u < m_Layers; u++)
+                {
+                    uint32_t srcU, srcV;
+                    if (turns == 2)
+                    {
+                        srcU = last - u;
+                        srcV = last - v;
+                    }
+                    else if ((turns == 1) == (axis == Direction::Horizontal))
+                    {
+                        srcU = v;
+                        srcV = last - u;
+                    }
+                    else
+                    {
+                        srcU = last - v;
+                        srcV = u;
+                    }
+
+                    uint32_t index = getIndex(layer, u, v);
+                    uint32_t srcIndex = srcV * m_Layers + srcU;
+                    if (colors)
+                    {
+                        m_CurrentPieceColors[index] = scratchPieceColors[srcIndex];
+                        m_CurrentPieceColors[index].HandleTransition(transition);
+                    }
+                    if (pieces)
+                        m_Pieces[index] = scratchPieces[srcIndex];
+                }
+            }
+        }
+    });
+}
+auto Cube::_RebuildPiecesFromColors() const -> void
+{
+    float pieceSize = m_Size / static_cast<float>(m_Layers);
+    Vector3 cornerPosition = m_Position - Vector3 { 
+        m_Size * 0.5f - pieceSize * 0.5f, 
+        m_Size * 0.5f - pieceSize * 0.5f,
+        m_Size * 0.5f - pieceSize * 0.5f
+    };
+
+    // an unrotated piece showing the colors of its location looks the same as the turned one
+    if (m_Pieces.size() != m_CurrentPieceColors.size())
+        m_Pieces.assign(m_CurrentPieceColors.size(), Piece { m_Position, 0.0f });
+
+    _ParallelFor(m_Layers, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t z = begin; z < end; z++)
+        {
+            for (uint32_t y = 0; y < m_Layers; y++)
+            {
+                for (uint32_t x = 0; x < m_Layers; x++)
+                {
+                    uint32_t index = z * m_Layers * m_Layers + y * m_Layers + x;
+                    Piece piece { cornerPosition + Vector3(x, y, z) * pieceSize, pieceSize * STICKER_SCALE };
+                    for (uint32_t face = 0; face < 6; face++)
+                        piece.SetFaceColor(static_cast<Face>(face), m_CurrentPieceColors[index].GetColors()[face]);
+
+                    m_Pieces[index] = piece;
+                }
+            }
+        }
+    });
+}
+
 auto Cube::_GetIndicesByTurn(const Turn& turn) const -> std::vector<PieceLocation>
 {
     switch (turn.LayerType)
@@ -6,14 +6,17 @@
 #include "AxialRotation/AxialRotation.hpp"
 #include "Move/Move.hpp"
 #include "Turn/Turn.hpp"
+#include "JobSystem/JobSystem.hpp"
 
 #include <raylib.h>
 
+#include <map>
 #include <memory>
 #include <vector>
 #include <queue>
 #include <optional>
 #include <algorithm>
+#include <functional>
 
 class Cube
 {
@@ -42,18 +45,12 @@ public:
     auto IsSolved() const -> bool;
     inline auto IsTurning() const -> bool { return !m_Rotations.empty(); }
 
-    inline auto SetSize(uint32_t size) -> void { m_Layers = size; Reset(); }
+    auto SetSize(uint32_t size) -> void;
     inline auto GetSize() const -> uint32_t { return m_Layers; }
     inline auto GetPieceColors(const PieceLocation& location) const -> std::optional<std::reference_wrapper<const PieceColors>>
     {
-        uint32_t index = location.Z * m_Layers * m_Layers + location.Y * m_Layers + location.X;
-        if (index >= m_Pieces.size())
-            return std::nullopt;
-        
-        return std::ref(m_CurrentPieceColors[index]);
-    }
-    inline auto GetPieceColors(const PieceLocation& location) -> std::optional<std::reference_wrapper<PieceColors>>
-    {
+        _ApplyDeferredTurnsToColors();
+
         uint32_t index = location.Z * m_Layers * m_Layers + location.Y * m_Layers + location.X;
         if (index >= m_Pieces.size())
             return std::nullopt;
@@ -62,13 +59,16 @@ public:
     }
     inline auto SetPieceColors(const PieceLocation& location, const PieceColors& pieceColors) -> void
     {
+        _ApplyDeferredTurnsToColors();
+        m_Pristine = false;
+
         uint32_t index = location.Z * m_Layers * m_Layers + location.Y * m_Layers + location.X;
         if (index >= m_Pieces.size())
             return;
         
         m_CurrentPieceColors[index] = pieceColors;
     }
-    auto GetPieceLocationByExactColors(FaceColor color, auto... colors) -> std::optional<PieceLocation>
+    auto GetPieceLocationByExactColors(FaceColor color, auto... colors) const -> std::optional<PieceLocation>
     {
         std::array<FaceColor, sizeof...(colors) + 1> searchColors = { color, colors... };
 
@@ -107,7 +107,7 @@ public:
 
         return std::nullopt;
     }
-    auto GetPieceLocationsByColors(FaceColor color, auto... colors) -> std::vector<PieceLocation>
+    auto GetPieceLocationsByColors(FaceColor color, auto... colors) const -> std::vector<PieceLocation>
     {
         std::vector<PieceLocation> locations;
         for (uint32_t z = 0; z < m_Layers; z++)
@@ -146,7 +146,21 @@ public:
     inline auto SetAnimationSpeed(float speed) -> void { m_AnimationSpeed = speed; }
     inline auto GetAnimationSpeed() const -> float { return m_AnimationSpeed; }
 
+    // while animations are disabled, turns are only logged and applied when the state is queried or drawn
+    inline auto SetDeferredTurnsEnabled(bool deferredTurns) -> void { m_DeferredTurns = deferredTurns; }
+    inline auto GetDeferredTurnsEnabled() const -> bool { return m_DeferredTurns; }
+
+    // every turn made until the recording stops is also kept, to take the turns of a solver on a headless cube
+    inline auto StartRecordingTurns() -> void { m_RecordedTurns.emplace(); }
+    inline auto StopRecordingTurns() -> std::vector<Turn>
+    {
+        std::vector<Turn> turns = std::move(m_RecordedTurns).value_or(std::vector<Turn> { });
+        m_RecordedTurns.reset();
+        return turns;
+    }
+
     auto Reset() -> void;
+    auto LoadPieceColors(const std::vector<PieceColors>& pieceColors) -> void;
     auto Update(float deltaTime) -> void;
     auto Draw() const -> void;
 
@@ -155,6 +169,21 @@ public:
 
 private:
     static constexpr float STICKER_SCALE = 0.9f;
+    static constexpr size_t PIECE_REBUILD_FACTOR = 4;
+    static constexpr uint32_t PARALLEL_MIN_LAYERS = 16;
+    static constexpr size_t SIZE_POOL_MEMORY_LIMIT = 512 * 1024 * 1024;
+
+    // solved buffers of a size: a template to copy from and the buffers of a solved cube left at that size
+    struct SizePoolEntry
+    {
+        std::vector<PieceColors> TemplatePieceColors;
+        std::vector<Piece> TemplatePieces;
+        std::vector<PieceColors> StashedPieceColors;
+        std::vector<Piece> StashedPieces;
+        uint64_t LastUse;
+
+        auto GetMemoryUsage() const -> size_t;
+    };
 
 private:
     inline auto _GetPiece(const PieceLocation& location) -> std::optional<std::reference_wrapper<Piece>>
@@ -184,6 +213,34 @@ private:
 
     auto _MakeBigMove(std::string_view move) -> void;
 
+    auto _LoadSolvedBuffers() -> void;
+    auto _BuildSolvedBuffers() -> void;
+    auto _TrimSizePool() -> void;
+
+    inline auto _IsDeferringTurns() const -> bool { return m_DeferredTurns && !m_Animations && m_Rotations.empty(); }
+    inline auto _ApplyDeferredTurnsToColors() const -> void
+    {
+        if (m_AppliedColorTurns != m_TurnLog.size())
+            _ApplyDeferredTurns(true, false);
+    }
+    inline auto _ApplyAllDeferredTurns() const -> void
+    {
+        if (!m_TurnLog.empty())
+            _ApplyDeferredTurns(true, true);
+    }
+    auto _ApplyDeferredTurns(bool colors, bool pieces) const -> void;
+    auto _ApplyAxisTurns(Direction axis, const std::vector<uint8_t>& quarterTurns, bool colors, bool pieces) const -> void;
+    auto _RebuildPiecesFromColors() const -> void;
+
+    // splits [0, count) across the job system on large cubes and runs it on the calling thread otherwise
+    inline auto _ParallelFor(uint32_t count, const std::function<void(uint32_t, uint32_t)>& job) const -> void
+    {
+        if (m_Layers < PARALLEL_MIN_LAYERS)
+            job(0, count);
+        else
+            JobSystem::Get().ParallelFor(0, count, 1, job);
+    }
+
     auto _GetIndicesByTurn(const Turn& turn) const -> std::vector<PieceLocation>;
     auto _GetIndicesByTurnInversed(const Turn& turn) const -> std::vector<PieceLocation>;
 
@@ -202,10 +259,22 @@ private:
     bool m_Animations;
     float m_AnimationSpeed;
 
-    std::vector<PieceColors> m_CurrentPieceColors;
-    std::vector<Piece> m_Pieces;
+    // the colors and the pieces are brought up to date lazily from the turn log
+    mutable std::vector<PieceColors> m_CurrentPieceColors;
+    mutable std::vector<Piece> m_Pieces;
+
+    bool m_DeferredTurns;
+    mutable std::vector<Turn> m_TurnLog;
+    mutable size_t m_AppliedColorTurns;
+    mutable size_t m_AppliedPieceTurns;
 
     std::queue<AxialRotation> m_Rotations;
+    std::optional<std::vector<Turn>> m_RecordedTurns;
+
+    // whether the buffers still hold the solved cube of the current size
+    bool m_Pristine;
+    std::map<uint32_t, SizePoolEntry> m_SizePool;
+    uint64_t m_SizePoolClock;
 
     Matrix m_RotationMatrix;
 };
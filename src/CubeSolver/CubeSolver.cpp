@@ -1,8 +1,110 @@
 #include "CubeSolver.hpp"
 #include "ColorPattern/ColorPattern.hpp"
+#include "CubeState/CubeState.hpp"
+#include "CubieCube/CubieCube.hpp"
+#include "FaceletString/FaceletString.hpp"
+#include "JobSystem/JobSystem.hpp"
+#include "LastLayerSolver/LastLayerSolver.hpp"
+#include "PairTable/PairTable.hpp"
+#include "PocketSolver/PocketSolver.hpp"
+#include "ReductionSolver/ReductionSolver.hpp"
+#include "Symmetry/Symmetry.hpp"
+#include "ThistlethwaiteSolver/ThistlethwaiteSolver.hpp"
+#include "TwoPhaseSolver/TwoPhaseSolver.hpp"
 
+#include <algorithm>
+#include <map>
+#include <set>
 #include <utility>
 
+static constexpr std::string_view FACE_LETTERS = "URFDLB";
+
+// the index of the face in the order of the facelets
+static auto GetFaceSlot(Face face) -> uint32_t
+{
+    switch (face)
+    {
+    case Face::Top:
+        return 0;
+    case Face::Right:
+        return 1;
+    case Face::Front:
+        return 2;
+    case Face::Bottom:
+        return 3;
+    case Face::Left:
+        return 4;
+    case Face::Back:
+        return 5;
+    case Face::None:
+        break;
+    }
+
+    std::unreachable();
+}
+
+// a piece put in a slot of a target, and how many stickers of the source it leaves in place there
+struct Placement
+{
+    uint8_t Piece;
+    uint8_t Orientation;
+    uint32_t Kept;
+};
+
+// gives every slot from this one on a piece, trying the placements in order; the orientations have to add up
+// to a multiple of the orientation count
+static auto AssignPieces(const std::vector<std::vector<Placement>>& placements, uint32_t orientations, uint32_t slot, uint32_t used,
+    uint32_t orientationSum, std::span<uint8_t> permutation, std::span<uint8_t> orientation) -> bool
+{
+    if (slot == placements.size())
+        return orientationSum % orientations == 0;
+
+    for (const Placement& placement : placements[slot])
+    {
+        if ((used & (1u << placement.Piece)) != 0)
+            continue;
+        if (slot + 1 == placements.size() && (orientationSum + placement.Orientation) % orientations != 0)
+            continue;
+
+        permutation[slot] = placement.Piece;
+        orientation[slot] = placement.Orientation;
+        if (AssignPieces(placements, orientations, slot + 1, used | (1u << placement.Piece), orientationSum + placement.Orientation, permutation, orientation))
+            return true;
+    }
+
+    return false;
+}
+// swaps two pieces that still fit where they go, which flips the parity of the permutation
+static auto SwapPieces(const std::vector<std::vector<Placement>>& placements, uint32_t orientations, std::span<uint8_t> permutation,
+    std::span<uint8_t> orientation) -> bool
+{
+    auto fits = [&placements](uint32_t slot, uint8_t piece, uint8_t pieceOrientation) {
+        return std::ranges::any_of(placements[slot], [=](const Placement& placement) {
+            return placement.Piece == piece && placement.Orientation == pieceOrientation;
+        });
+    };
+
+    for (uint32_t a = 0; a < placements.size(); a++)
+    {
+        for (uint32_t b = a + 1; b < placements.size(); b++)
+        {
+            for (uint8_t orientationA = 0; orientationA < orientations; orientationA++)
+            {
+                uint8_t orientationB = (orientation[a] + orientation[b] + orientations - orientationA) % orientations;
+                if (!fits(a, permutation[b], orientationA) || !fits(b, permutation[a], orientationB))
+                    continue;
+
+                std::swap(permutation[a], permutation[b]);
+                orientation[a] = orientationA;
+                orientation[b] = orientationB;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 const std::array<Algorithm, 7> CubeSolver::s_2x2_OLLs = {
     Algorithm {
         .Pattern = ColorPattern { "DBDBDDDB" },
@@ -363,20 +465,777 @@ const std::array<Algorithm, 21> CubeSolver::s_3x3_PLLs = {
     }
 };
 
-CubeSolver::CubeSolver(Cube& cube)
-    : m_Cube(cube) { }
+// the shortest insertion of the front right pair over <U, R, F, L, B> for every case with its pieces in the
+// U layer or in their slot, keeping the cross and the other slots
+const std::array<std::string_view, 149> CubeSolver::s_3x3_F2Ls = {
+    "R U2 R' U' R U R'",
+    "U2 R B U B2 R B R2",
+    "U2 R2 U2 R' U' R U' R2",
+    "F' U2 F U F' U' F",
+    "R B U2 B' R'",
+    "U' F' U2 F2 R' F' R",
+    "U R U B' R B R2",
+    "F' L' U2 L F",
+    "R2 U R2 U R2 U2 R2",
+    "R U' R' F' U2 F",
+    "U2 R2 U R' U R U2 R2",
+    "R U' R' U2 F' U' F",
+    "R U' B U2 B' U2 R'",
+    "U2 F' U2 F",
+    "F2 U' L' U L F2",
+    "R2 B U B' U' R2",
+    "R U R'",
+    "R2 U2 F R2 F' U2 R2",
+    "U R U2 B U2 B' R'",
+    "U F' U' F U' R U R'",
+    "U R U' R'",
+    "F U2 F2 U' F2 U' F'",
+    "R U2 B U B' U R'",
+    "U F' U F U' F' U' F",
+    "R U B U2 B' U R'",
+    "F' U' F",
+    "F2 L' U' L U F2",
+    "R2 U B U' B' R2",
+    "U2 R B U2 B' U2 R'",
+    "U2 R U R' U2 F' U2 F",
+    "R U B' R B R2",
+    "U F' L F' L' F2",
+    "U R2 U2 F R F' U2 R2",
+    "U R B U B2 R B R2",
+    "U R2 U2 R' U' R U' R2",
+    "U F2 U2 R' F' R U2 F2",
+    "U R B' R B R2",
+    "U2 F' U2 F2 R' F' R",
+    "R U' B U2 B' U R'",
+    "R U2 R' F' U' F",
+    "U' R U R'",
+    "F' U2 F U F' U2 F",
+    "U R2 U R' U R U2 R2",
+    "U' R U' R' U2 F' U' F",
+    "F' U2 F U' R U R'",
+    "U F' U2 F",
+    "U' F2 U' L' U L F2",
+    "U F' L' U' L U2 F",
+    "R U2 B U2 B' R'",
+    "F' U' F U' R U R'",
+    "U R B U B' U2 R'",
+    "U' R2 U B U' B' R2",
+    "R U' R'",
+    "U2 R U2 R' U F' U' F",
+    "U' R U2 B U B' U R'",
+    "F' U F U' F' U' F",
+    "R U B U2 B' U2 R'",
+    "U' F' U' F",
+    "U R B U2 B' U2 R'",
+    "U R U R' U2 F' U2 F",
+    "R B' R B R2",
+    "U F' U2 F2 R' F' R",
+    "U' R U B' R B R2",
+    "F' L F' L' F2",
+    "R2 U2 F R F' U2 R2",
+    "R B U B2 R B R2",
+    "R2 U2 R' U' R U' R2",
+    "F2 U2 R' F' R U2 F2",
+    "R U' B U B' U R'",
+    "U F' U2 F R U R'",
+    "U2 F2 U' L' U L F2",
+    "F' L' U' L U2 F",
+    "U2 R U R'",
+    "U F' U' L' U2 L U2 F",
+    "R2 U R' U R U2 R2",
+    "U2 R U' R' U2 F' U' F",
+    "U2 R U' B U2 B' U2 R'",
+    "F' U2 F",
+    "F' L' U2 L U2 F",
+    "F' U F U R U R'",
+    "U R U2 R' U2 R U' R'",
+    "U2 F' U' F",
+    "R B U B' U2 R'",
+    "U2 R2 U B U' B' R2",
+    "R U2 R'",
+    "U R U2 R' U F' U' F",
+    "U2 R U2 B U B' U R'",
+    "F2 U' F U' F' U2 F2",
+    "R B U2 B' U2 R'",
+    "R U R' U2 F' U2 F",
+    "U' R2 U2 R' U' R U' R2",
+    "U F' U2 F U F' U' F",
+    "U R B U2 B' R'",
+    "F' U2 F2 R' F' R",
+    "U2 R U B' R B R2",
+    "U F' L' U2 L F",
+    "U R U2 R' U' R U R'",
+    "U' R B U B2 R B R2",
+    "F' U L' U2 L U' F",
+    "F' U2 F R U R'",
+    "U R U' B U2 B' U2 R'",
+    "F' U F",
+    "U F2 U' L' U L F2",
+    "U R2 B U B' U' R2",
+    "U R U R'",
+    "F' U' L' U2 L U2 F",
+    "R U' R' U R U R'",
+    "U R U' R' U2 F' U' F",
+    "U2 R U2 B U2 B' R'",
+    "U2 F' U' F U' R U R'",
+    "U R U2 B U B' U R'",
+    "U2 F' U F U' F' U' F",
+    "R U2 R' U2 R U' R'",
+    "U F' U' F",
+    "U F2 L' U' L U F2",
+    "U R2 U B U' B' R2",
+    "U2 R U' R'",
+    "R U2 R' U F' U' F",
+    "F' U2 L' U2 L F",
+    "R U R' U F' U' F",
+    "R' U2 B' R' B U2 R",
+    "R U2 R' U2 F' U' F",
+    "F' U2 F U2 R U R'",
+    "R' U2 B' R B U2 R",
+    "R U2 B U2 B' U2 R'",
+    "R U R' U' F' U' F",
+    "R U2 B U B' U2 R'",
+    "F U2 L F2 L' U2 F'",
+    "R U' R U2 F R2 F' U2 R2",
+    "R U2 B' R B R2",
+    "U2 R' F R F2 U' F",
+    "U2 R B U2 B' U R'",
+    "U R' F R F2 U' F",
+    "U R B U2 B' U R'",
+    "R' F R F2 U' F",
+    "R B U2 B' U R'",
+    "R U' R' F' U' F",
+    "R U2 R U2 F R F' U2 R2",
+    "R U2 B U B2 R B R2",
+    "U2 R2 B' R' B U2 R'",
+    "U R U2 R' F' U2 F",
+    "U R2 B' R' B U2 R'",
+    "R U2 R' F' U2 F",
+    "R2 B' R' B U2 R'",
+    "F' L' U2 L U' F",
+    "R U' B U2 B' R'",
+    "U2 R U2 R' F' U2 F",
+    "R U2 R U R' U R U2 R2",
+    "R U' R' F' L' U2 L F"
+};
+
+const CaseTable CubeSolver::s_2x2_OLLCases(s_2x2_OLLs);
+const CaseTable CubeSolver::s_2x2_PLLCases(s_2x2_PLLs);
+
+const CaseTable CubeSolver::s_3x3_OLLCases(s_3x3_OLLs);
+const CaseTable CubeSolver::s_3x3_PLLCases(s_3x3_PLLs);
+
+const PairTable CubeSolver::s_3x3_F2LCases(s_3x3_F2Ls);
+
+// the rotations about the U axis, each one brings another slot to the front right
+const std::vector<uint32_t> CubeSolver::s_F2LRotations = [] {
+    std::vector<uint32_t> rotations;
+    for (uint32_t symmetry = 0; symmetry < Symmetry::COUNT; symmetry++)
+    {
+        if (Symmetry::ConjugateMove(symmetry, 0) == 0)
+            rotations.push_back(symmetry);
+    }
+
+    return rotations;
+}();
+const std::array<std::string_view, 3> CubeSolver::s_F2LExtractions = { "R U R'", "R U' R'", "R U2 R'" };
+
+// closed over a quarter turn about the U axis and one about the R axis
+const std::array<std::array<uint8_t, 6>, CubeSolver::COLOR_ORIENTATIONS> CubeSolver::s_ColorRotations = [] {
+    constexpr std::array<uint8_t, 6> IDENTITY = { 0, 1, 2, 3, 4, 5 };
+    constexpr std::array<std::array<uint8_t, 6>, 2> GENERATORS = {{
+        { 0, 5, 1, 3, 2, 4 },
+        { 5, 1, 0, 2, 4, 3 }
+    }};
+
+    std::array<std::array<uint8_t, 6>, COLOR_ORIENTATIONS> rotations = { IDENTITY };
+    uint32_t count = 1;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (const auto& generator : GENERATORS)
+        {
+            std::array<uint8_t, 6> rotation;
+            for (uint32_t face = 0; face < 6; face++)
+                rotation[face] = generator[rotations[i][face]];
+
+            if (std::find(rotations.begin(), rotations.begin() + count, rotation) == rotations.begin() + count)
+                rotations[count++] = rotation;
+        }
+    }
+
+    return rotations;
+}();
+
+CubeSolver::CubeSolver(Cube& cube, Strategy strategy)
+    : m_Cube(cube), m_Strategy(strategy), m_ColorNeutralTimeCap(DEFAULT_COLOR_NEUTRAL_TIME_CAP), m_ThinkingTime(0), m_ExecutePlan(false), m_Thinking(false),
+      m_SeenImprovements(0) { }
 
 auto CubeSolver::Solve() -> void
+{
+    Execute(Plan(CubeState::FromCube(m_Cube)));
+}
+auto CubeSolver::Plan(const CubeState& state, std::stop_token stopToken, const std::function<void(float)>& progress) const
+    -> std::vector<Turn>
+{
+    if (state.GetSize() >= ReductionSolver::MIN_SIZE)
+        return ReductionSolver::Solve(state, stopToken, progress).value_or(std::vector<Turn> { });
+
+    if (state.GetSize() == 3 && m_Strategy == Strategy::LAYER_BY_LAYER && m_ColorNeutralTimeCap.count() > 0)
+        return PlanColorNeutral(state, m_ColorNeutralTimeCap, stopToken).Turns;
+
+    return _PlanHeadless(state, m_Strategy, stopToken);
+}
+auto CubeSolver::_PlanHeadless(const CubeState& state, Strategy strategy, std::stop_token stopToken) const -> std::vector<Turn>
+{
+    // the solvers of the small sizes read and turn a cube, a headless one records their turns
+    Cube cube(state.GetSize(), { 0.0f, 0.0f, 0.0f }, 1.0f);
+    cube.SetAnimationsEnabled(false);
+    state.ApplyTo(cube);
+
+    CubeSolver solver(cube, strategy);
+    solver.m_StopToken = stopToken;
+    cube.StartRecordingTurns();
+    solver._Solve();
+
+    std::vector<Turn> turns = cube.StopRecordingTurns();
+    return stopToken.stop_requested() ? std::vector<Turn> { } : turns;
+}
+auto CubeSolver::_GetTurns(std::span<const uint32_t> moves) -> std::vector<Turn>
+{
+    Cube cube(3, { 0.0f, 0.0f, 0.0f }, 1.0f);
+    cube.SetAnimationsEnabled(false);
+
+    cube.StartRecordingTurns();
+    cube.MakeMoves(CubieCube::FormatMoves(moves));
+
+    return cube.StopRecordingTurns();
+}
+auto CubeSolver::_RelabelTarget(const CubeState& from, const CubeState& to) -> std::optional<CubeState>
+{
+    uint32_t size = from.GetSize();
+    if (to.GetSize() != size)
+        return std::nullopt;
+
+    // the facelets of every piece, by its location
+    std::map<uint32_t, std::vector<uint32_t>> pieces;
+    for (uint32_t facelet = 0; facelet < from.GetFacelets().size(); facelet++)
+    {
+        PieceLocation location = from.GetFaceletLocation(facelet);
+        pieces[(location.X * size + location.Y) * size + location.Z].push_back(facelet);
+    }
+    auto getColors = [](const CubeState& state, const std::vector<uint32_t>& facelets) {
+        std::string colors;
+        for (uint32_t facelet : facelets)
+            colors += state.GetFacelet(facelet);
+
+        std::ranges::sort(colors);
+        return colors;
+    };
+
+    // a piece is told apart by its colors, and each of its stickers by its own color
+    std::map<std::pair<std::string, char>, char> letters;
+    std::set<std::string> targetPieces;
+    for (const auto& [location, facelets] : pieces)
+    {
+        std::string colors = getColors(to, facelets);
+        if (!targetPieces.insert(colors).second)
+            return std::nullopt;
+
+        for (uint32_t facelet : facelets)
+            letters[{ colors, to.GetFacelet(facelet) }] = FACE_LETTERS[facelet / (size * size)];
+    }
+
+    std::string relabeled = from.GetFacelets();
+    for (const auto& [location, facelets] : pieces)
+    {
+        std::string colors = getColors(from, facelets);
+        for (uint32_t facelet : facelets)
+        {
+            auto it = letters.find({ colors, from.GetFacelet(facelet) });
+            if (it == letters.end())
+                return std::nullopt;
+
+            relabeled[facelet] = it->second;
+        }
+    }
+
+    if (FaceletString::Validate(relabeled) != FaceletString::Validity::VALID)
+        return std::nullopt;
+
+    return CubeState::FromFacelets(relabeled);
+}
+auto CubeSolver::_CompleteTarget(const CubeState& from, const CubeState& to, const std::vector<bool>& mask) -> std::optional<CubeState>
+{
+    uint32_t size = from.GetSize();
+    if ((size != 2 && size != 3) || to.GetSize() != size || mask.size() != to.GetFacelets().size())
+        return std::nullopt;
+
+    // the colors of the faces: the 3x3 tries the orientations of its centers that show the masked ones, its own
+    // first; every orientation of the 2x2 can be reached, the one of its DBL corner in the source is kept
+    if (size == 3)
+    {
+        for (const auto& [rotated, turns] : _GetRotations(from))
+        {
+            std::array<char, 6> colors;
+            bool fits = true;
+            for (uint32_t slot = 0; slot < 6 && fits; slot++)
+            {
+                colors[slot] = rotated.GetFacelet(slot * 9 + 4);
+                fits = !mask[slot * 9 + 4] || to.GetFacelet(slot * 9 + 4) == colors[slot];
+            }
+
+            std::optional<CubeState> target = fits ? _CompleteTarget(from, to, mask, colors) : std::nullopt;
+            if (target.has_value())
+                return target;
+        }
+
+        return std::nullopt;
+    }
+
+    std::array<char, 6> colors;
+    PieceLocation corner = CubieCube::GetCornerLocation(CubieCube::DBL, size);
+    for (Face face : { Face::Bottom, Face::Left, Face::Back })
+    {
+        char color = from.GetFacelet(FaceletString::GetFaceletIndex(size, face, corner));
+        size_t letter = FACE_LETTERS.find(color);
+        if (letter == std::string_view::npos)
+            return std::nullopt;
+
+        colors[GetFaceSlot(face)] = color;
+        colors[(GetFaceSlot(face) + 3) % 6] = FACE_LETTERS[(letter + 3) % 6];
+    }
+
+    return _CompleteTarget(from, to, mask, colors);
+}
+auto CubeSolver::_CompleteTarget(const CubeState& from, const CubeState& to, const std::vector<bool>& mask, const std::array<char, 6>& colors)
+    -> std::optional<CubeState>
+{
+    uint32_t size = from.GetSize();
+
+    // the placements of every piece in every slot showing the masked colors, those keeping the most stickers first
+    auto getPlacements = [&](std::span<const PieceLocation> locations, const auto& faces) {
+        std::vector<std::vector<Placement>> placements(locations.size());
+        uint32_t orientations = faces[0].size();
+        for (uint32_t slot = 0; slot < locations.size(); slot++)
+        {
+            for (uint32_t piece = 0; piece < locations.size(); piece++)
+            {
+                for (uint32_t orientation = 0; orientation < orientations; orientation++)
+                {
+                    Placement placement = { (uint8_t)piece, (uint8_t)orientation, 0 };
+                    bool fits = true;
+                    for (uint32_t k = 0; k < orientations && fits; k++)
+                    {
+                        uint32_t facelet = FaceletString::GetFaceletIndex(size, faces[slot][(k + orientation) % orientations], locations[slot]);
+                        char color = colors[GetFaceSlot(faces[piece][k])];
+                        fits = !mask[facelet] || to.GetFacelet(facelet) == color;
+                        placement.Kept += from.GetFacelet(facelet) == color;
+                    }
+
+                    if (fits)
+                        placements[slot].push_back(placement);
+                }
+            }
+
+            std::ranges::stable_sort(placements[slot], std::greater { }, &Placement::Kept);
+        }
+
+        return placements;
+    };
+
+    std::vector<PieceLocation> cornerLocations;
+    for (uint32_t corner = 0; corner < 8; corner++)
+        cornerLocations.push_back(CubieCube::GetCornerLocation(corner, size));
+
+    CubieCube target = CubieCube::Solved();
+    auto cornerPlacements = getPlacements(cornerLocations, CubieCube::s_CornerFaces);
+    if (!AssignPieces(cornerPlacements, 3, 0, 0, 0, target.CornerPermutation, target.CornerOrientation))
+        return std::nullopt;
+
+    if (size == 3)
+    {
+        std::vector<PieceLocation> edgeLocations;
+        for (uint32_t edge = 0; edge < 12; edge++)
+            edgeLocations.push_back(CubieCube::GetEdgeLocation(edge));
+
+        auto edgePlacements = getPlacements(edgeLocations, CubieCube::s_EdgeFaces);
+        if (!AssignPieces(edgePlacements, 2, 0, 0, 0, target.EdgePermutation, target.EdgeOrientation))
+            return std::nullopt;
+
+        if (target.GetCornerParity() != target.GetEdgeParity() &&
+            !SwapPieces(edgePlacements, 2, target.EdgePermutation, target.EdgeOrientation) &&
+            !SwapPieces(cornerPlacements, 3, target.CornerPermutation, target.CornerOrientation))
+            return std::nullopt;
+    }
+
+    std::string facelets = target.ToFacelets(size);
+    for (char& facelet : facelets)
+        facelet = colors[FACE_LETTERS.find(facelet)];
+
+    return CubeState::FromFacelets(facelets);
+}
+auto CubeSolver::_GetRotation(const CubeState& state) -> std::vector<Turn>
+{
+    std::string solved = CubeState(state.GetSize()).GetFacelets();
+    for (auto& [rotated, turns] : _GetRotations(state))
+    {
+        if (rotated.GetFacelets() == solved)
+            return turns;
+    }
+
+    return { };
+}
+auto CubeSolver::_GetRotations(const CubeState& state) -> std::vector<std::pair<CubeState, std::vector<Turn>>>
+{
+    // a breadth first search, a whole cube turn turns every layer of an axis
+    std::vector<std::pair<CubeState, std::vector<Turn>>> orientations = { { state, { } } };
+    for (size_t i = 0; i < orientations.size(); i++)
+    {
+        for (Direction axis : { Direction::Vertical, Direction::Horizontal, Direction::Depthical })
+        {
+            for (bool clockwise : { true, false })
+            {
+                auto [next, turns] = orientations[i];
+                for (uint32_t layer = 0; layer < state.GetSize(); layer++)
+                {
+                    Turn turn = { axis, layer, clockwise };
+                    next.ApplyTurn(turn);
+                    turns.push_back(turn);
+                }
+
+                auto seen = [&next](const auto& orientation) { return orientation.first.GetFacelets() == next.GetFacelets(); };
+                if (std::ranges::none_of(orientations, seen))
+                    orientations.emplace_back(std::move(next), std::move(turns));
+            }
+        }
+    }
+
+    return orientations;
+}
+auto CubeSolver::Execute(std::span<const Turn> turns) -> void
+{
+    // turns of distinct layers on one axis commute, a run of them is animated as one multi-layer turn
+    std::vector<Turn> group;
+    auto flush = [this, &group]() {
+        if (group.size() == 1)
+            m_Cube.MakeTurn(group.front());
+        else if (group.size() > 1)
+            m_Cube.MakeMultiLayerTurn(group);
+
+        group.clear();
+    };
+
+    for (const Turn& turn : turns)
+    {
+        bool fits = std::ranges::all_of(group, [&turn](const Turn& other) {
+            return other.LayerType == turn.LayerType && other.LayerIndex != turn.LayerIndex;
+        });
+        if (!fits)
+            flush();
+
+        group.push_back(turn);
+    }
+    flush();
+}
+
+auto CubeSolver::Solve(const CubeState& state, std::chrono::steady_clock::time_point deadline,
+    const std::function<void(const std::vector<Turn>&)>& improved, std::stop_token stopToken) const -> std::vector<Turn>
+{
+    // the searching strategies don't see the deadline, the layer by layer plan is ready in a fraction of a
+    // millisecond and the search below improves on it
+    bool searching = m_Strategy == Strategy::TWO_PHASE || m_Strategy == Strategy::THISTLETHWAITE;
+    std::vector<Turn> best = state.GetSize() == 3 && searching ? _PlanHeadless(state, Strategy::LAYER_BY_LAYER, stopToken) : Plan(state, stopToken);
+    if (improved)
+        improved(best);
+
+    // the 2x2 plans are optimal already and the larger cubes have no other method
+    auto cubieCube = CubieCube::FromFacelets(state.GetFacelets());
+    if (state.GetSize() != 3 || !cubieCube.has_value() || best.empty())
+        return best;
+
+    TwoPhaseSolver::Improve(cubieCube.value(), deadline, stopToken, [&best, &improved](std::span<const uint32_t> moves) {
+        // shorter in face moves is not always shorter in quarter turns
+        std::vector<Turn> turns = _GetTurns(moves);
+        if (turns.size() >= best.size())
+            return;
+
+        best = std::move(turns);
+        if (improved)
+            improved(best);
+    });
+
+    return best;
+}
+auto CubeSolver::SolveTo(const CubeState& from, const CubeState& to, std::stop_token stopToken) const
+    -> std::optional<std::vector<Turn>>
+{
+    auto relabeled = _RelabelTarget(from, to);
+    if (!relabeled.has_value())
+        return std::nullopt;
+
+    std::vector<Turn> turns = Plan(relabeled.value(), stopToken);
+    CubeState state = relabeled.value();
+    state.ApplyTurns(turns);
+    if (!state.IsSolved())
+        return std::nullopt;
+
+    // the strategy may leave the whole cube turned, the target is matched facelet for facelet
+    std::vector<Turn> rotation = _GetRotation(state);
+    turns.insert(turns.end(), rotation.begin(), rotation.end());
+    return turns;
+}
+auto CubeSolver::SolveTo(const CubeState& from, const CubeState& to, const std::vector<bool>& mask, std::stop_token stopToken) const
+    -> std::optional<std::vector<Turn>>
+{
+    if (to.GetSize() != from.GetSize() || mask.size() != to.GetFacelets().size())
+        return std::nullopt;
+
+    bool matches = true;
+    for (uint32_t facelet = 0; facelet < mask.size() && matches; facelet++)
+        matches = !mask[facelet] || from.GetFacelet(facelet) == to.GetFacelet(facelet);
+    if (matches)
+        return std::vector<Turn> { };
+
+    auto target = _CompleteTarget(from, to, mask);
+    if (!target.has_value())
+        return std::nullopt;
+
+    return SolveTo(from, target.value(), stopToken);
+}
+auto CubeSolver::PlanColorNeutral(const CubeState& state, std::chrono::milliseconds timeCap, std::stop_token stopToken) const
+    -> ColorNeutralPlan
+{
+    auto deadline = std::chrono::steady_clock::now() + timeCap;
+    constexpr std::string_view FACES = "URFDLB";
+
+    // the turns solving a recolored cube solve the cube itself, its faces are uniform at the same time
+    std::array<std::optional<std::vector<Turn>>, COLOR_ORIENTATIONS> plans;
+    JobSystem::Get().ParallelFor(0, COLOR_ORIENTATIONS, 1, [&](uint32_t first, uint32_t last) {
+        for (uint32_t orientation = first; orientation < last; orientation++)
+        {
+            if (orientation != 0 && (stopToken.stop_requested() || std::chrono::steady_clock::now() >= deadline))
+                continue;
+
+            std::string facelets = state.GetFacelets();
+            for (char& facelet : facelets)
+            {
+                size_t face = FACES.find(facelet);
+                if (face != std::string_view::npos)
+                    facelet = FACES[s_ColorRotations[orientation][face]];
+            }
+
+            plans[orientation] = _PlanHeadless(CubeState::FromFacelets(facelets).value(), m_Strategy, stopToken);
+        }
+    });
+
+    uint32_t best = 0;
+    for (uint32_t orientation = 1; orientation < COLOR_ORIENTATIONS; orientation++)
+    {
+        if (plans[orientation].has_value() && plans[orientation]->size() < plans[best]->size())
+            best = orientation;
+    }
+
+    // the colors recolored to white and to green
+    const auto& rotation = s_ColorRotations[best];
+    auto getColor = [&rotation, FACES](char face) {
+        uint32_t original = std::find(rotation.begin(), rotation.end(), FACES.find(face)) - rotation.begin();
+        return FaceletString::CharToColor(FACES[original]);
+    };
+
+    return ColorNeutralPlan {
+        .Turns = std::move(plans[best].value()),
+        .BaseColor = getColor('U'),
+        .FrontColor = getColor('F')
+    };
+}
+auto CubeSolver::GetSolutionCache() -> SolutionCache&
+{
+    static SolutionCache cache;
+    return cache;
+}
+
+auto CubeSolver::PlanAsync() -> void
+{
+    // the previous worker finishes on its own, with its own job
+    CancelSolve();
+    if (m_Worker.joinable())
+        m_StoppedWorkers.emplace_back(std::move(m_Worker), std::move(m_Job));
+    _ReapStoppedWorkers();
+
+    m_PlanState = CubeState::FromCube(m_Cube);
+    m_Job = std::make_shared<Job>();
+
+    auto deadline = std::chrono::steady_clock::now() + m_ThinkingTime;
+    bool thinking = m_ThinkingTime.count() > 0 && m_PlanState->GetSize() < ReductionSolver::MIN_SIZE;
+    m_Thinking = thinking;
+    m_PlayedTurns.clear();
+    m_RemainingTurns.clear();
+    m_SeenImprovements = 0;
+    m_Worker = std::jthread([this, job = m_Job, state = m_PlanState.value(), deadline, thinking](std::stop_token stopToken) {
+        auto report = [&job](float progress) { job->Progress.store(progress, std::memory_order_relaxed); };
+        auto plan = [&]() -> bool {
+            // the reduction streams its turns as it decides them, the small sizes are planned at once
+            if (state.GetSize() >= ReductionSolver::MIN_SIZE)
+            {
+                TurnGenerator generator = ReductionSolver::Stream(state, stopToken, report);
+                while (std::optional<std::vector<Turn>> batch = generator.Next())
+                {
+                    if (!job->Channel.Push(batch.value(), stopToken))
+                        return false;
+                }
+
+                return true;
+            }
+
+            if (thinking)
+            {
+                Solve(state, deadline, [&job](const std::vector<Turn>& turns) {
+                    std::lock_guard lock(job->PlanMutex);
+                    job->BestPlan = turns;
+                    job->Improvements++;
+                }, stopToken);
+
+                return !stopToken.stop_requested();
+            }
+
+            return job->Channel.Push(Plan(state, stopToken, report), stopToken);
+        };
+
+        if (plan())
+        {
+            job->Progress.store(1.0f, std::memory_order_relaxed);
+            job->Channel.Close();
+        }
+
+        job->Finished.store(true, std::memory_order_release);
+    });
+}
+auto CubeSolver::SolveAsync() -> void
+{
+    if (!IsSolving() || CubeState::FromCube(m_Cube).GetFacelets() != m_PlanState->GetFacelets())
+        PlanAsync();
+
+    m_ExecutePlan = true;
+    Update();
+}
+auto CubeSolver::CancelSolve() -> void
+{
+    m_Worker.request_stop();
+    m_ExecutePlan = false;
+}
+auto CubeSolver::_ReapStoppedWorkers() -> void
+{
+    std::erase_if(m_StoppedWorkers, [](const auto& stopped) { return stopped.second->Finished.load(std::memory_order_acquire); });
+}
+auto CubeSolver::_TakeImprovedPlan() -> void
+{
+    std::lock_guard lock(m_Job->PlanMutex);
+    if (m_Job->Improvements == m_SeenImprovements)
+        return;
+
+    bool first = m_SeenImprovements == 0;
+    m_SeenImprovements = m_Job->Improvements;
+
+    // the played turns the plan starts with are kept, the others are undone
+    const std::vector<Turn>& plan = m_Job->BestPlan;
+    size_t kept = 0;
+    while (kept < m_PlayedTurns.size() && kept < plan.size() && m_PlayedTurns[kept] == plan[kept])
+        kept++;
+
+    std::vector<Turn> turns;
+    for (size_t i = m_PlayedTurns.size(); i-- > kept;)
+        turns.push_back({ m_PlayedTurns[i].LayerType, m_PlayedTurns[i].LayerIndex, !m_PlayedTurns[i].Clockwise });
+    turns.insert(turns.end(), plan.begin() + kept, plan.end());
+
+    if (first || turns.size() < m_RemainingTurns.size())
+        m_RemainingTurns = std::move(turns);
+}
+auto CubeSolver::_UpdateThinking() -> void
+{
+    _TakeImprovedPlan();
+    if (m_SeenImprovements == 0 || m_Cube.IsTurning())
+        return;
+
+    if (m_RemainingTurns.empty())
+    {
+        // the plan is played, the search still running has nothing left to improve
+        CancelSolve();
+        m_StoppedWorkers.emplace_back(std::move(m_Worker), m_Job);
+        return;
+    }
+
+    // the turns only fit the cube as long as nothing else turned it
+    if (CubeState::FromCube(m_Cube).GetFacelets() != m_PlanState->GetFacelets())
+    {
+        CancelSolve();
+        return;
+    }
+
+    Turn turn = m_RemainingTurns.front();
+    m_RemainingTurns.erase(m_RemainingTurns.begin());
+    Execute(std::span(&turn, 1));
+    m_PlanState->ApplyTurn(turn);
+    m_PlayedTurns.push_back(turn);
+}
+auto CubeSolver::Update() -> void
+{
+    _ReapStoppedWorkers();
+
+    if (!m_ExecutePlan || m_Worker.get_stop_token().stop_requested())
+        return;
+
+    if (m_Thinking)
+    {
+        _UpdateThinking();
+        return;
+    }
+
+    std::vector<Turn> turns = m_Job->Channel.Pop();
+    if (!turns.empty())
+    {
+        // the turns only fit the cube as long as nothing else turned it
+        if (CubeState::FromCube(m_Cube).GetFacelets() != m_PlanState->GetFacelets())
+        {
+            CancelSolve();
+            return;
+        }
+
+        Execute(turns);
+        m_PlanState->ApplyTurns(turns);
+    }
+
+    // the worker only closes the channel right before it returns
+    if (m_Job->Channel.IsDrained())
+    {
+        m_Worker.join();
+        m_ExecutePlan = false;
+    }
+}
+
+auto CubeSolver::_Solve() -> void
 {
     if (m_Cube.IsSolved())
         return;
 
     if (m_Cube.GetSize() == 2)
+    {
+        if (_SolvePocket())
+            return;
+
         _Solve2x2();
+    }
     else if (m_Cube.GetSize() == 3)
+    {
+        if (m_Strategy == Strategy::TWO_PHASE && _SolveTwoPhase())
+            return;
+        if (m_Strategy == Strategy::THISTLETHWAITE && _SolveThistlethwaite())
+            return;
+        // a stopped plan is thrown away
+        if (m_StopToken.stop_requested())
+            return;
+
         _Solve3x3();
-    else
-        return;
+    }
 }
 
 auto CubeSolver::_Solve2x2() -> void
@@ -388,8 +1247,8 @@ auto CubeSolver::_Solve2x2() -> void
     _SolveCorner(FaceColor::White, FaceColor::Orange, FaceColor::Blue, { lastLayerIndex, 0, 0 }, FaceColor::White);
     _SolveCorner(FaceColor::White, FaceColor::Red, FaceColor::Blue, { 0, 0, 0 }, FaceColor::White);
 
-    _SolveOLL(s_2x2_OLLs, FaceColor::Yellow);
-    _SolvePLL(s_2x2_PLLs);
+    _SolveOLL(s_2x2_OLLCases, FaceColor::Yellow);
+    _SolvePLL(s_2x2_PLLCases);
     _SolveAUF();
 }
 auto CubeSolver::_Solve3x3() -> void
@@ -404,21 +1263,72 @@ auto CubeSolver::_Solve3x3() -> void
     _SolveEdgeToBottom(FaceColor::White, FaceColor::Orange, { lastLayerIndex, 0, 1 }, FaceColor::White);
     _SolveEdgeToBottom(FaceColor::White, FaceColor::Green, { 1, 0, lastLayerIndex }, FaceColor::White);
 
-    _SolveCorner(FaceColor::White, FaceColor::Red, FaceColor::Green, { 0, 0, lastLayerIndex }, FaceColor::White);
-    _SolveCorner(FaceColor::White, FaceColor::Orange, FaceColor::Green, { lastLayerIndex, 0, lastLayerIndex }, FaceColor::White);
-    _SolveCorner(FaceColor::White, FaceColor::Orange, FaceColor::Blue, { lastLayerIndex, 0, 0 }, FaceColor::White);
-    _SolveCorner(FaceColor::White, FaceColor::Red, FaceColor::Blue, { 0, 0, 0 }, FaceColor::White);
+    // the beginner steps only finish what the pair table could not
+    if (!_SolveF2L())
+    {
+        _SolveCorner(FaceColor::White, FaceColor::Red, FaceColor::Green, { 0, 0, lastLayerIndex }, FaceColor::White);
+        _SolveCorner(FaceColor::White, FaceColor::Orange, FaceColor::Green, { lastLayerIndex, 0, lastLayerIndex }, FaceColor::White);
+        _SolveCorner(FaceColor::White, FaceColor::Orange, FaceColor::Blue, { lastLayerIndex, 0, 0 }, FaceColor::White);
+        _SolveCorner(FaceColor::White, FaceColor::Red, FaceColor::Blue, { 0, 0, 0 }, FaceColor::White);
+
+        _SolveEdgeToSecondLayer(FaceColor::Red, FaceColor::Blue, { 0, 1, 0 });
+        _SolveEdgeToSecondLayer(FaceColor::Blue, FaceColor::Orange, { lastLayerIndex, 1, 0 });
+        _SolveEdgeToSecondLayer(FaceColor::Orange, FaceColor::Green, { lastLayerIndex, 1, lastLayerIndex });
+        _SolveEdgeToSecondLayer(FaceColor::Red, FaceColor::Green, { 0, 1, lastLayerIndex });
+    }
 
-    _SolveEdgeToSecondLayer(FaceColor::Red, FaceColor::Blue, { 0, 1, 0 });
-    _SolveEdgeToSecondLayer(FaceColor::Blue, FaceColor::Orange, { lastLayerIndex, 1, 0 });
-    _SolveEdgeToSecondLayer(FaceColor::Orange, FaceColor::Green, { lastLayerIndex, 1, lastLayerIndex });
-    _SolveEdgeToSecondLayer(FaceColor::Red, FaceColor::Green, { 0, 1, lastLayerIndex });
+    if (_SolveLastLayer())
+        return;
 
-    _SolveOLL(s_3x3_OLLs, FaceColor::Yellow);
-    _SolvePLL(s_3x3_PLLs);
+    _SolveOLL(s_3x3_OLLCases, FaceColor::Yellow);
+    _SolvePLL(s_3x3_PLLCases);
     _SolveAUF();
 }
 
+auto CubeSolver::_SolvePocket() -> bool
+{
+    auto cubieCube = CubieCube::FromCube(m_Cube);
+    if (!cubieCube.has_value())
+        return false;
+
+    auto solution = PocketSolver::Solve(cubieCube.value());
+    if (!solution.has_value())
+        return false;
+
+    m_Cube.MakeMoves(CubieCube::FormatMoves(solution.value()));
+    return true;
+}
+auto CubeSolver::_SolveTwoPhase() -> bool
+{
+    auto cubieCube = CubieCube::FromCube(m_Cube);
+    if (!cubieCube.has_value())
+        return false;
+
+    auto solution = GetSolutionCache().Solve(cubieCube.value(), [this](const CubieCube& cube) -> std::optional<std::vector<uint32_t>> {
+        auto solution = TwoPhaseSolver::Solve(cube, TwoPhaseSolver::DEFAULT_LENGTH, TwoPhaseSolver::DEFAULT_TIMEOUT, m_StopToken);
+
+        // a stopped search may not have found a short solution yet, it is not cached
+        return m_StopToken.stop_requested() ? std::nullopt : solution;
+    });
+    if (!solution.has_value())
+        return false;
+
+    m_Cube.MakeMoves(CubieCube::FormatMoves(solution.value()));
+    return true;
+}
+auto CubeSolver::_SolveThistlethwaite() -> bool
+{
+    auto cubieCube = CubieCube::FromCube(m_Cube);
+    if (!cubieCube.has_value())
+        return false;
+
+    auto solution = ThistlethwaiteSolver::Solve(cubieCube.value());
+    if (!solution.has_value())
+        return false;
+
+    m_Cube.MakeMoves(CubieCube::FormatMoves(solution.value()));
+    return true;
+}
 
 auto CubeSolver::_SolveCorner(FaceColor color1, FaceColor color2, FaceColor color3, PieceLocation destLocation, FaceColor bottomColor) -> void
 {
@@ -474,39 +1384,113 @@ auto CubeSolver::_SolveEdgeToSecondLayer(FaceColor color1, FaceColor color2, Pie
         destLocation
     );
 }
-auto CubeSolver::_SolveOLL(const std::span<const Algorithm>& OLLs, FaceColor faceColor) -> void
+auto CubeSolver::_SolveF2L() -> bool
 {
-    ColorPattern OLLPattern = ColorPattern::CreateOLLPatternFromTopLayer(m_Cube, faceColor);
-    for (const auto& OLL : OLLs)
+    for (uint32_t step = 0; step < MAX_F2L_STEPS; step++)
     {
-        uint32_t match = OLLPattern.Match(OLL.Pattern);
-        if (match != 5)
+        auto cubieCube = CubieCube::FromCube(m_Cube);
+        if (!cubieCube.has_value())
+            return false;
+
+        auto pair = _FindF2LPair(cubieCube.value());
+        if (pair.has_value())
         {
-            // align the OLL pattern
-            for (uint32_t i = 0; i < match; i++)
-                m_Cube.MakeMove(Move::U_);
+            m_Cube.MakeMoves(CubieCube::FormatMoves(pair.value()));
+            continue;
+        }
 
-            m_Cube.MakeMoves(OLL.Moves);
-            break;
+        // every pair left has a piece in another slot, so a slot is emptied, the one leading to the cheapest pair
+        std::optional<std::string> extraction;
+        size_t extractionCost = 0;
+        for (uint32_t rotation : s_F2LRotations)
+        {
+            if (PairTable::IsSolved(Symmetry::Conjugate(cubieCube.value(), rotation)))
+                continue;
+
+            for (std::string_view moves : s_F2LExtractions)
+            {
+                std::string mapped = Symmetry::MapSolution(moves, rotation);
+                CubieCube extracted = cubieCube.value();
+                extracted.ApplyMoves(mapped);
+
+                auto next = _FindF2LPair(extracted);
+                size_t cost = next.has_value() ? next->size() : MAX_F2L_COST;
+                if (!extraction.has_value() || cost < extractionCost)
+                {
+                    extraction = mapped;
+                    extractionCost = cost;
+                }
+            }
         }
+
+        if (!extraction.has_value())
+            return true;
+
+        m_Cube.MakeMoves(extraction.value());
     }
+
+    return false;
 }
-auto CubeSolver::_SolvePLL(const std::span<const Algorithm>& PLLs) -> void
+auto CubeSolver::_FindF2LPair(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>
 {
-    ColorPattern PLLPattern = ColorPattern::CreatePLLPatternFromTopLayer(m_Cube);
-    for (const auto& PLL : PLLs)
+    const std::vector<uint32_t>* best = nullptr;
+    uint32_t bestRotation = 0;
+    for (uint32_t rotation : s_F2LRotations)
     {
-        uint32_t match = PLLPattern.Match(PLL.Pattern);
-        if (match != 5)
-        {
-            // align the OLL pattern
-            for (uint32_t i = 0; i < match; i++)
-                m_Cube.MakeMove(Move::U_);
+        CubieCube rotated = Symmetry::Conjugate(cube, rotation);
+        if (PairTable::IsSolved(rotated))
+            continue;
 
-            m_Cube.MakeMoves(PLL.Moves);
-            break;
+        const std::vector<uint32_t>* solution = s_3x3_F2LCases.Find(rotated);
+        if (solution != nullptr && (best == nullptr || solution->size() < best->size()))
+        {
+            best = solution;
+            bestRotation = rotation;
         }
     }
+
+    if (best == nullptr)
+        return std::nullopt;
+
+    return Symmetry::MapSolution(*best, bestRotation);
+}
+auto CubeSolver::_SolveOLL(const CaseTable& OLLs, FaceColor faceColor) -> void
+{
+    auto OLL = OLLs.Find(ColorPattern::CreateOLLPatternFromTopLayer(m_Cube, faceColor));
+    if (!OLL)
+        return;
+
+    // align the OLL pattern
+    for (uint32_t i = 0; i < OLL->Rotation; i++)
+        m_Cube.MakeMove(Move::U_);
+
+    m_Cube.MakeMoves(OLL->Match->Moves);
+}
+auto CubeSolver::_SolvePLL(const CaseTable& PLLs) -> void
+{
+    auto PLL = PLLs.Find(ColorPattern::CreatePLLPatternFromTopLayer(m_Cube));
+    if (!PLL)
+        return;
+
+    // align the PLL pattern
+    for (uint32_t i = 0; i < PLL->Rotation; i++)
+        m_Cube.MakeMove(Move::U_);
+
+    m_Cube.MakeMoves(PLL->Match->Moves);
+}
+auto CubeSolver::_SolveLastLayer() -> bool
+{
+    auto cubieCube = CubieCube::FromCube(m_Cube);
+    if (!cubieCube.has_value())
+        return false;
+
+    // nullopt without the table file
+    auto solution = LastLayerSolver::Solve(cubieCube.value());
+    if (!solution.has_value())
+        return false;
+
+    m_Cube.MakeMoves(CubieCube::FormatMoves(solution.value()));
+    return true;
 }
 auto CubeSolver::_SolveAUF() -> void
 {
@@ -818,7 +1802,7 @@ auto CubeSolver::_MoveInsertedEdgeToTop(PieceLocation location) -> PieceLocation
 }
 auto CubeSolver::_MoveEdgeOnTopAboveCorrectSlot(PieceLocation location) -> PieceLocation
 {
-    PieceColors& edgeColors = m_Cube.GetPieceColors(location).value().get();
+    const PieceColors& edgeColors = m_Cube.GetPieceColors(location).value().get();
 
     // get the side color
     FaceColor sideColor;
@@ -2,16 +2,102 @@
 #define CUBESOLVER_H
 
 #include "Cube/Cube.hpp"
+#include "CubeState/CubeState.hpp"
 #include "Algorithm/Algorithm.hpp"
+#include "CaseTable/CaseTable.hpp"
+#include "PairTable/PairTable.hpp"
+#include "SolutionCache/SolutionCache.hpp"
+#include "Turn/Turn.hpp"
+#include "TurnChannel/TurnChannel.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <span>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
 
 class CubeSolver
 {
 public:
-    explicit CubeSolver(Cube& cube);
+    enum class Strategy
+    {
+        LAYER_BY_LAYER = 0,
+        TWO_PHASE,
+        // shorter tables than the two phase search, longer solutions
+        THISTLETHWAITE
+    };
 
+    struct ColorNeutralPlan
+    {
+        std::vector<Turn> Turns;
+        // the colors the winning orientation built the first layer with and kept in front
+        FaceColor BaseColor;
+        FaceColor FrontColor;
+    };
+
+    static constexpr uint32_t COLOR_ORIENTATIONS = 24;
+    static constexpr std::chrono::milliseconds DEFAULT_COLOR_NEUTRAL_TIME_CAP = std::chrono::milliseconds(100);
+
+public:
+    explicit CubeSolver(Cube& cube, Strategy strategy = Strategy::LAYER_BY_LAYER);
+
+    // plans on a copy of the cube and replays the plan on it
     auto Solve() -> void;
+    // the turns solving the state, computed without the live cube; empty if it can't be solved or was stopped
+    auto Plan(const CubeState& state, std::stop_token stopToken = { }, const std::function<void(float)>& progress = { }) const
+        -> std::vector<Turn>;
+    auto Execute(std::span<const Turn> turns) -> void;
+    // anytime: the plan of the strategy at once (the layer by layer plan for the searching 3x3 strategies), then
+    // shorter ones from a two-phase search of the 3x3 until the deadline or the stop, within a millisecond of it;
+    // improved is called with each plan as it is found
+    auto Solve(const CubeState& state, std::chrono::steady_clock::time_point deadline,
+        const std::function<void(const std::vector<Turn>&)>& improved = { }, std::stop_token stopToken = { }) const
+        -> std::vector<Turn>;
+    // the turns taking one state to the other, facelet for facelet: the source is relabeled by where each of its
+    // pieces sits in the target, so whatever the strategy solves it with reaches the target; nullopt when the
+    // target is not reachable, when its pieces are not told apart by their colors (cubes larger than 3x3) or
+    // when the plan was stopped
+    auto SolveTo(const CubeState& from, const CubeState& to, std::stop_token stopToken = { }) const
+        -> std::optional<std::vector<Turn>>;
+    // only the facelets set in the mask have to match the target, the others end up anywhere; the 2x2 and the 3x3
+    auto SolveTo(const CubeState& from, const CubeState& to, const std::vector<bool>& mask, std::stop_token stopToken = { }) const
+        -> std::optional<std::vector<Turn>>;
+    // plans the layer by layer 3x3 solve for each orientation of the colors in parallel and keeps the shortest
+    // plan; orientations not started within the time cap are skipped, the white base with green in front
+    // always runs
+    auto PlanColorNeutral(const CubeState& state, std::chrono::milliseconds timeCap, std::stop_token stopToken = { }) const
+        -> ColorNeutralPlan;
+
+    // plans on a worker thread and keeps the plan, SolveAsync executes it if the cube is still in that state;
+    // with a thinking time the worker hands over its first plan at once and improves it that long, the
+    // improvements replacing the turns not played yet
+    auto PlanAsync() -> void;
+    // reuses the plan made or being made for the current state, or starts one; Update executes its turns as the
+    // worker streams them, and stops the solve when the cube was turned in between
+    auto SolveAsync() -> void;
+    // requests the worker to stop without waiting for it, its plan is never executed
+    auto CancelSolve() -> void;
+    auto Update() -> void;
+    inline auto IsSolving() const -> bool { return m_Worker.joinable() && !m_Worker.get_stop_token().stop_requested(); }
+    inline auto GetProgress() const -> float { return m_Job != nullptr ? m_Job->Progress.load(std::memory_order_relaxed) : 0.0f; }
+
+    // the 3x3 strategy, 2x2s are always solved optimally and larger cubes by reduction
+    inline auto SetStrategy(Strategy strategy) -> void { m_Strategy = strategy; }
+    inline auto GetStrategy() const -> Strategy { return m_Strategy; }
+    // how long a layer by layer 3x3 plan may start orientations, zero only plans the white base
+    inline auto SetColorNeutralTimeCap(std::chrono::milliseconds timeCap) -> void { m_ColorNeutralTimeCap = timeCap; }
+    inline auto GetColorNeutralTimeCap() const -> std::chrono::milliseconds { return m_ColorNeutralTimeCap; }
+    inline auto SetThinkingTime(std::chrono::milliseconds thinkingTime) -> void { m_ThinkingTime = thinkingTime; }
+    inline auto GetThinkingTime() const -> std::chrono::milliseconds { return m_ThinkingTime; }
+
+    // the two-phase 3x3 solutions of every solver, by symmetry class
+    static auto GetSolutionCache() -> SolutionCache&;
 
 private:
     static const std::array<Algorithm, 7> s_2x2_OLLs;
@@ -20,16 +106,66 @@ private:
     static const std::array<Algorithm, 57> s_3x3_OLLs;
     static const std::array<Algorithm, 21> s_3x3_PLLs;
 
+    static const CaseTable s_2x2_OLLCases;
+    static const CaseTable s_2x2_PLLCases;
+
+    static const CaseTable s_3x3_OLLCases;
+    static const CaseTable s_3x3_PLLCases;
+
+    static const std::array<std::string_view, 149> s_3x3_F2Ls;
+    static const PairTable s_3x3_F2LCases;
+
+    static const std::vector<uint32_t> s_F2LRotations;
+    // the moves taking the front right slot's pieces to the U layer, without touching the other slots
+    static const std::array<std::string_view, 3> s_F2LExtractions;
+
+    // the pairs inserted and the slots emptied before leaving the rest to the beginner steps
+    static constexpr uint32_t MAX_F2L_STEPS = 12;
+    static constexpr size_t MAX_F2L_COST = 100;
+
+    // the face letters of the 24 whole cube rotations, in URFDLB order, starting with the identity
+    static const std::array<std::array<uint8_t, 6>, COLOR_ORIENTATIONS> s_ColorRotations;
+
 private:
+    // the plan of a small cube from a headless cube solved with the given strategy, empty when stopped
+    auto _PlanHeadless(const CubeState& state, Strategy strategy, std::stop_token stopToken) const -> std::vector<Turn>;
+    // drops the stopped workers that finished, their threads have nothing left to run
+    auto _ReapStoppedWorkers() -> void;
+    // switches to the latest plan of a thinking worker when it takes fewer turns from where the cube is now
+    auto _TakeImprovedPlan() -> void;
+    auto _UpdateThinking() -> void;
+    // the turns of 3x3 face moves
+    static auto _GetTurns(std::span<const uint32_t> moves) -> std::vector<Turn>;
+    // every sticker of the source as the letter of the face it is on in the target, nullopt if it is not there
+    static auto _RelabelTarget(const CubeState& from, const CubeState& to) -> std::optional<CubeState>;
+    // a reachable target matching the masked facelets, keeping as many stickers of the source in place as it can
+    static auto _CompleteTarget(const CubeState& from, const CubeState& to, const std::vector<bool>& mask) -> std::optional<CubeState>;
+    // with the colors of the faces in the order of the facelets
+    static auto _CompleteTarget(const CubeState& from, const CubeState& to, const std::vector<bool>& mask, const std::array<char, 6>& colors)
+        -> std::optional<CubeState>;
+    // the whole cube turns bringing the faces of a solved state to their places
+    static auto _GetRotation(const CubeState& state) -> std::vector<Turn>;
+    // the 24 orientations of the state and the whole cube turns reaching them, the state itself first
+    static auto _GetRotations(const CubeState& state) -> std::vector<std::pair<CubeState, std::vector<Turn>>>;
+    auto _Solve() -> void;
     auto _Solve2x2() -> void;
     auto _Solve3x3() -> void;
+    auto _SolvePocket() -> bool;
+    auto _SolveTwoPhase() -> bool;
+    auto _SolveThistlethwaite() -> bool;
 
     auto _SolveCorner(FaceColor color1, FaceColor color2, FaceColor color3, PieceLocation destLocation, FaceColor bottomColor) -> void;
     auto _SolveEdgeToBottom(FaceColor color1, FaceColor color2, PieceLocation destLocation, FaceColor bottomColor) -> void;
     auto _SolveEdgeToSecondLayer(FaceColor color1, FaceColor color2, PieceLocation destLocation) -> void;
 
-    auto _SolveOLL(const std::span<const Algorithm>& OLLs, FaceColor faceColor) -> void;
-    auto _SolvePLL(const std::span<const Algorithm>& PLLs) -> void;
+    // inserts the cheapest pair the table knows until all four are in, false when it gets stuck
+    auto _SolveF2L() -> bool;
+    // the moves of the cheapest pair the table knows, over the four slots
+    static auto _FindF2LPair(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>;
+    auto _SolveOLL(const CaseTable& OLLs, FaceColor faceColor) -> void;
+    auto _SolvePLL(const CaseTable& PLLs) -> void;
+    // one look from the stored last layer cases, false when they were not generated
+    auto _SolveLastLayer() -> bool;
     auto _SolveAUF() -> void;
 
     auto _SolveWhiteCenterToBottom() -> void;
@@ -49,6 +185,43 @@ private:
 
 private:
     Cube& m_Cube;
+    Strategy m_Strategy;
+    std::chrono::milliseconds m_ColorNeutralTimeCap;
+    std::chrono::milliseconds m_ThinkingTime;
+
+    // the stop of the plan a headless solver runs for
+    std::stop_token m_StopToken;
+
+    static constexpr size_t CHANNEL_CAPACITY = 4096;
+
+    // what a worker hands over, owned with it, so a stopped worker still running never writes into the next plan
+    struct Job
+    {
+        TurnChannel Channel { CHANNEL_CAPACITY };
+        std::atomic<float> Progress = 0.0f;
+        std::atomic<bool> Finished = false;
+
+        // with a thinking time, the best plan from the planned state so far and how often it improved
+        std::mutex PlanMutex;
+        std::vector<Turn> BestPlan;
+        uint32_t Improvements = 0;
+    };
+
+    // the state the turns left in the channel start from
+    std::optional<CubeState> m_PlanState;
+    std::shared_ptr<Job> m_Job;
+    bool m_ExecutePlan;
+
+    // a thinking plan is played one turn at a time, so an improvement still replaces the turns not played yet
+    bool m_Thinking;
+    std::vector<Turn> m_PlayedTurns;
+    std::vector<Turn> m_RemainingTurns;
+    uint32_t m_SeenImprovements;
+
+    // last, so they are joined before the members they read are destroyed; a stopped worker is only joined
+    // once it finished, a search or a table build never blocks the thread that restarts the plan
+    std::jthread m_Worker;
+    std::vector<std::pair<std::jthread, std::shared_ptr<Job>>> m_StoppedWorkers;
 };
 
 #endif
\ No newline at end of file
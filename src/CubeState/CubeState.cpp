@@ -0,0 +1,220 @@
+#include "CubeState.hpp"
+
+#include "FaceletString/FaceletString.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+using Normal = std::array<int32_t, 3>;
+
+static auto GetNormal(Face face) -> Normal
+{
+    switch (face)
+    {
+    case Face::Top:
+        return { 0, 1, 0 };
+    case Face::Front:
+        return { 0, 0, 1 };
+    case Face::Right:
+        return { 1, 0, 0 };
+    case Face::Back:
+        return { 0, 0, -1 };
+    case Face::Left:
+        return { -1, 0, 0 };
+    case Face::Bottom:
+        return { 0, -1, 0 };
+    case Face::None:
+        break;
+    }
+
+    std::unreachable();
+}
+static auto GetFace(const Normal& normal) -> Face
+{
+    if (normal[0] != 0)
+        return normal[0] > 0 ? Face::Right : Face::Left;
+    if (normal[1] != 0)
+        return normal[1] > 0 ? Face::Top : Face::Bottom;
+
+    return normal[2] > 0 ? Face::Front : Face::Back;
+}
+// the coordinate a turn of the layer type keeps, the other two are the next ones cyclically
+static auto GetAxis(Direction layerType) -> uint32_t
+{
+    switch (layerType)
+    {
+    case Direction::Vertical:
+        return 0;
+    case Direction::Horizontal:
+        return 1;
+    case Direction::Depthical:
+        return 2;
+    }
+
+    std::unreachable();
+}
+
+CubeState::CubeState(uint32_t size)
+    : m_Size(size), m_Facelets(6 * size * size, ' ')
+{
+    for (uint32_t slot = 0; slot < s_FaceOrder.size(); slot++)
+        std::fill_n(m_Facelets.begin() + slot * size * size, size * size, "URFDLB"[slot]);
+}
+
+auto CubeState::FromCube(const Cube& cube) -> CubeState
+{
+    CubeState state(cube.GetSize());
+    state.m_Facelets = FaceletString::Export(cube);
+    return state;
+}
+auto CubeState::FromFacelets(std::string_view facelets) -> std::optional<CubeState>
+{
+    uint32_t size = FaceletString::GetSize(facelets);
+    if (size == 0)
+        return std::nullopt;
+
+    CubeState state(size);
+    state.m_Facelets = facelets;
+    return state;
+}
+auto CubeState::ApplyTo(Cube& cube) const -> void
+{
+    FaceletString::Import(cube, m_Facelets);
+}
+
+auto CubeState::GetFaceletIndex(Face face, uint32_t row, uint32_t col) const -> uint32_t
+{
+    uint32_t slot = static_cast<uint32_t>(std::ranges::find(s_FaceOrder, face) - s_FaceOrder.begin());
+    return slot * m_Size * m_Size + row * m_Size + col;
+}
+auto CubeState::GetFaceletFace(uint32_t facelet) const -> Face
+{
+    return s_FaceOrder[facelet / (m_Size * m_Size)];
+}
+
+// the inverse of FaceletString::GetFaceletIndex
+auto CubeState::GetFaceletLocation(uint32_t facelet) const -> PieceLocation
+{
+    const uint32_t last = m_Size - 1;
+    uint32_t row = facelet % (m_Size * m_Size) / m_Size;
+    uint32_t col = facelet % m_Size;
+
+    switch (GetFaceletFace(facelet))
+    {
+    case Face::Top:
+        return { col, last, row };
+    case Face::Right:
+        return { last, last - row, last - col };
+    case Face::Front:
+        return { col, last - row, last };
+    case Face::Bottom:
+        return { col, 0, last - row };
+    case Face::Left:
+        return { 0, last - row, col };
+    case Face::Back:
+        return { last - col, last - row, 0 };
+
+    default:
+        std::unreachable();
+    }
+}
+
+auto CubeState::IsSolved() const -> bool
+{
+    uint32_t area = m_Size * m_Size;
+    for (uint32_t slot = 0; slot < s_FaceOrder.size(); slot++)
+    {
+        auto begin = m_Facelets.begin() + slot * area;
+        if (std::any_of(begin, begin + area, [first = *begin](char facelet) { return facelet != first; }))
+            return false;
+    }
+
+    return true;
+}
+
+auto CubeState::ApplyTurn(const Turn& turn) -> void
+{
+    _GetLayerFacelets(turn, m_LayerFacelets);
+
+    m_LayerColors.resize(m_LayerFacelets.size());
+    for (uint32_t i = 0; i < m_LayerFacelets.size(); i++)
+        m_LayerColors[i] = m_Facelets[m_LayerFacelets[i]];
+    for (uint32_t i = 0; i < m_LayerFacelets.size(); i++)
+        m_Facelets[GetFaceletAfterTurn(m_LayerFacelets[i], turn)] = m_LayerColors[i];
+}
+auto CubeState::ApplyTurns(std::span<const Turn> turns) -> void
+{
+    for (const Turn& turn : turns)
+        ApplyTurn(turn);
+}
+
+auto CubeState::GetFaceletAfterTurn(uint32_t facelet, const Turn& turn) const -> uint32_t
+{
+    const uint32_t last = m_Size - 1;
+    Face face = GetFaceletFace(facelet);
+    PieceLocation location = GetFaceletLocation(facelet);
+    std::array<uint32_t, 3> coordinates = { location.X, location.Y, location.Z };
+
+    uint32_t axis = GetAxis(turn.LayerType);
+    if (coordinates[axis] != turn.LayerIndex)
+        return facelet;
+
+    // a clockwise quarter turn seen from the positive side takes (u, v) to (v, last - u)
+    uint32_t u = (axis + 1) % 3, v = (axis + 2) % 3;
+    Normal normal = GetNormal(face);
+    if (turn.Clockwise)
+    {
+        std::tie(coordinates[u], coordinates[v]) = std::pair(coordinates[v], last - coordinates[u]);
+        std::tie(normal[u], normal[v]) = std::pair(normal[v], -normal[u]);
+    }
+    else
+    {
+        std::tie(coordinates[u], coordinates[v]) = std::pair(last - coordinates[v], coordinates[u]);
+        std::tie(normal[u], normal[v]) = std::pair(-normal[v], normal[u]);
+    }
+
+    return FaceletString::GetFaceletIndex(m_Size, GetFace(normal), { coordinates[0], coordinates[1], coordinates[2] });
+}
+
+auto CubeState::_GetLayerFacelets(const Turn& turn, std::vector<uint32_t>& facelets) const -> void
+{
+    const uint32_t last = m_Size - 1;
+    uint32_t axis = GetAxis(turn.LayerType);
+    uint32_t u = (axis + 1) % 3, v = (axis + 2) % 3;
+
+    facelets.clear();
+    auto add = [this, &facelets](const std::array<uint32_t, 3>& coordinates, const Normal& normal) {
+        facelets.push_back(FaceletString::GetFaceletIndex(m_Size, GetFace(normal), { coordinates[0], coordinates[1], coordinates[2] }));
+    };
+
+    // the stickers around the layer
+    for (uint32_t t = 0; t < m_Size; t++)
+    {
+        std::array<uint32_t, 3> coordinates;
+        coordinates[axis] = turn.LayerIndex;
+
+        Normal normal = { 0, 0, 0 };
+        coordinates[u] = 0, coordinates[v] = t, normal[u] = -1;
+        add(coordinates, normal);
+        coordinates[u] = last, normal[u] = 1;
+        add(coordinates, normal);
+
+        normal = { 0, 0, 0 };
+        coordinates[v] = 0, coordinates[u] = t, normal[v] = -1;
+        add(coordinates, normal);
+        coordinates[v] = last, normal[v] = 1;
+        add(coordinates, normal);
+    }
+
+    // and the face of an outer layer
+    if (turn.LayerIndex == 0 || turn.LayerIndex == last)
+    {
+        Normal normal = { 0, 0, 0 };
+        normal[axis] = turn.LayerIndex == 0 ? -1 : 1;
+
+        uint32_t slot = static_cast<uint32_t>(std::ranges::find(s_FaceOrder, GetFace(normal)) - s_FaceOrder.begin());
+        for (uint32_t i = 0; i < m_Size * m_Size; i++)
+            facelets.push_back(slot * m_Size * m_Size + i);
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef CUBESTATE_H
+#define CUBESTATE_H
+
+#include "Cube/Cube.hpp"
+#include "Face/Face.hpp"
+#include "Piece/PieceLocation.hpp"
+#include "Turn/Turn.hpp"
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A headless NxN cube: only the facelets, in the FaceletString layout, and the layer turns of the Cube on
+// them. The solvers plan on it without pieces, animations or the live cube.
+class CubeState
+{
+public:
+    explicit CubeState(uint32_t size);
+
+    static auto FromCube(const Cube& cube) -> CubeState;
+    // nullopt if the length is not 6 * N^2, the colors are not validated
+    static auto FromFacelets(std::string_view facelets) -> std::optional<CubeState>;
+    auto ApplyTo(Cube& cube) const -> void;
+
+    inline auto GetSize() const -> uint32_t { return m_Size; }
+    inline auto GetFacelets() const -> const std::string& { return m_Facelets; }
+    inline auto GetFacelet(uint32_t facelet) const -> char { return m_Facelets[facelet]; }
+    inline auto GetFacelet(Face face, uint32_t row, uint32_t col) const -> char { return m_Facelets[GetFaceletIndex(face, row, col)]; }
+
+    // the index of a facelet by the row and the column on its face as seen from the outside
+    auto GetFaceletIndex(Face face, uint32_t row, uint32_t col) const -> uint32_t;
+    auto GetFaceletFace(uint32_t facelet) const -> Face;
+    auto GetFaceletLocation(uint32_t facelet) const -> PieceLocation;
+
+    auto IsSolved() const -> bool;
+
+    auto ApplyTurn(const Turn& turn) -> void;
+    auto ApplyTurns(std::span<const Turn> turns) -> void;
+
+    // where the sticker on a facelet is after the turn
+    auto GetFaceletAfterTurn(uint32_t facelet, const Turn& turn) const -> uint32_t;
+
+private:
+    static constexpr std::array<Face, 6> s_FaceOrder = {
+        Face::Top, Face::Right, Face::Front, Face::Bottom, Face::Left, Face::Back
+    };
+
+private:
+    auto _GetLayerFacelets(const Turn& turn, std::vector<uint32_t>& facelets) const -> void;
+
+private:
+    uint32_t m_Size;
+    std::string m_Facelets;
+
+    std::vector<uint32_t> m_LayerFacelets;
+    std::string m_LayerColors;
+};
+
+#endif
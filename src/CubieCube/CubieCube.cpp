@@ -0,0 +1,444 @@
+#include "CubieCube.hpp"
+
+#include "FaceletString/FaceletString.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <span>
+#include <utility>
+
+using enum CubieCube::Corner;
+using enum CubieCube::Edge;
+
+const std::array<std::array<Face, 3>, 8> CubieCube::s_CornerFaces = {{
+    { Face::Top, Face::Right, Face::Front },
+    { Face::Top, Face::Front, Face::Left },
+    { Face::Top, Face::Left, Face::Back },
+    { Face::Top, Face::Back, Face::Right },
+    { Face::Bottom, Face::Front, Face::Right },
+    { Face::Bottom, Face::Left, Face::Front },
+    { Face::Bottom, Face::Back, Face::Left },
+    { Face::Bottom, Face::Right, Face::Back }
+}};
+
+const std::array<std::array<Face, 2>, 12> CubieCube::s_EdgeFaces = {{
+    { Face::Top, Face::Right },
+    { Face::Top, Face::Front },
+    { Face::Top, Face::Left },
+    { Face::Top, Face::Back },
+    { Face::Bottom, Face::Right },
+    { Face::Bottom, Face::Front },
+    { Face::Bottom, Face::Left },
+    { Face::Bottom, Face::Back },
+    { Face::Front, Face::Right },
+    { Face::Front, Face::Left },
+    { Face::Back, Face::Left },
+    { Face::Back, Face::Right }
+}};
+
+// the basic quarter turns of the faces in U, R, F, D, L, B order
+static const std::array<CubieCube, 6> s_BasicMoves = {{
+    {
+        { UBR, URF, UFL, ULB, DFR, DLF, DBL, DRB }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+        { UB, UR, UF, UL, DR, DF, DL, DB, FR, FL, BL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+    },
+    {
+        { DFR, UFL, ULB, URF, DRB, DLF, DBL, UBR }, { 2, 0, 0, 1, 1, 0, 0, 2 },
+        { FR, UF, UL, UB, BR, DF, DL, DB, DR, FL, BL, UR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+    },
+    {
+        { UFL, DLF, ULB, UBR, URF, DFR, DBL, DRB }, { 1, 2, 0, 0, 2, 1, 0, 0 },
+        { UR, FL, UL, UB, DR, FR, DL, DB, UF, DF, BL, BR }, { 0, 1, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0 }
+    },
+    {
+        { URF, UFL, ULB, UBR, DLF, DBL, DRB, DFR }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+        { UR, UF, UL, UB, DF, DL, DB, DR, FR, FL, BL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+    },
+    {
+        { URF, ULB, DBL, UBR, DFR, UFL, DLF, DRB }, { 0, 1, 2, 0, 0, 2, 1, 0 },
+        { UR, UF, BL, UB, DR, DF, FL, DB, FR, UL, DL, BR }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+    },
+    {
+        { URF, UFL, UBR, DRB, DFR, DLF, ULB, DBL }, { 0, 0, 1, 2, 0, 0, 2, 1 },
+        { UR, UF, UL, BR, DR, DF, DL, BL, FR, FL, UB, DB }, { 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 1, 1 }
+    }
+}};
+
+static constexpr std::array<std::string_view, CubieCube::MOVE_COUNT> s_MoveNames = {
+    "U", "U2", "U'", "R", "R2", "R'", "F", "F2", "F'",
+    "D", "D2", "D'", "L", "L2", "L'", "B", "B2", "B'"
+};
+
+static auto BuildMoves() -> std::array<CubieCube, CubieCube::MOVE_COUNT>
+{
+    std::array<CubieCube, CubieCube::MOVE_COUNT> moves;
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        CubieCube cube = CubieCube::Solved();
+        for (uint32_t power = 0; power < 3; power++)
+        {
+            cube.Multiply(s_BasicMoves[face]);
+            moves[face * 3 + power] = cube;
+        }
+    }
+
+    return moves;
+}
+
+static auto FaceToChar(Face face) -> char
+{
+    switch (face)
+    {
+    case Face::Top:
+        return 'U';
+    case Face::Front:
+        return 'F';
+    case Face::Right:
+        return 'R';
+    case Face::Back:
+        return 'B';
+    case Face::Left:
+        return 'L';
+    case Face::Bottom:
+        return 'D';
+    case Face::None:
+        return '?';
+    }
+
+    std::unreachable();
+}
+
+static auto IsOddPermutation(std::span<const uint8_t> permutation) -> bool
+{
+    bool odd = false;
+    for (uint32_t i = 0; i < permutation.size(); i++)
+        for (uint32_t j = i + 1; j < permutation.size(); j++)
+            odd ^= permutation[i] > permutation[j];
+
+    return odd;
+}
+
+// the cubies from the home face of the sticker on every face of every corner and edge slot
+static auto ReadPieces(uint32_t size, const auto& getHomeFace) -> std::optional<CubieCube>
+{
+    CubieCube result = CubieCube::Solved();
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        PieceLocation location = CubieCube::GetCornerLocation(i, size);
+        std::array<Face, 3> faces;
+        for (uint32_t k = 0; k < 3; k++)
+            faces[k] = getHomeFace(location, CubieCube::s_CornerFaces[i][k]);
+
+        uint32_t orientation = 0;
+        while (orientation < 3 && faces[orientation] != Face::Top && faces[orientation] != Face::Bottom)
+            orientation++;
+        if (orientation == 3)
+            return std::nullopt;
+
+        auto it = std::ranges::find_if(CubieCube::s_CornerFaces, [&](const auto& corner) {
+            return corner[1] == faces[(orientation + 1) % 3] && corner[2] == faces[(orientation + 2) % 3];
+        });
+        if (it == CubieCube::s_CornerFaces.end())
+            return std::nullopt;
+
+        result.CornerPermutation[i] = std::distance(CubieCube::s_CornerFaces.begin(), it);
+        result.CornerOrientation[i] = orientation;
+    }
+    if (size == 2)
+        return result;
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        PieceLocation location = CubieCube::GetEdgeLocation(i);
+        Face first = getHomeFace(location, CubieCube::s_EdgeFaces[i][0]);
+        Face second = getHomeFace(location, CubieCube::s_EdgeFaces[i][1]);
+
+        bool found = false;
+        for (uint32_t j = 0; j < 12 && !found; j++)
+        {
+            if (CubieCube::s_EdgeFaces[j][0] == first && CubieCube::s_EdgeFaces[j][1] == second)
+                result.EdgeOrientation[i] = 0;
+            else if (CubieCube::s_EdgeFaces[j][0] == second && CubieCube::s_EdgeFaces[j][1] == first)
+                result.EdgeOrientation[i] = 1;
+            else
+                continue;
+
+            result.EdgePermutation[i] = j;
+            found = true;
+        }
+        if (!found)
+            return std::nullopt;
+    }
+
+    return result;
+}
+
+auto CubieCube::Multiply(const CubieCube& other) -> void
+{
+    CubieCube result;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        result.CornerPermutation[i] = CornerPermutation[other.CornerPermutation[i]];
+        result.CornerOrientation[i] = s_OrientationProducts[CornerOrientation[other.CornerPermutation[i]]][other.CornerOrientation[i]];
+    }
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        result.EdgePermutation[i] = EdgePermutation[other.EdgePermutation[i]];
+        result.EdgeOrientation[i] = EdgeOrientation[other.EdgePermutation[i]] ^ other.EdgeOrientation[i];
+    }
+
+    *this = result;
+}
+auto CubieCube::ApplyMove(uint32_t move) -> void
+{
+    Multiply(GetMove(move));
+}
+auto CubieCube::ApplyMoves(std::string_view moves) -> bool
+{
+    for (auto token : moves | std::views::split(' '))
+    {
+        std::string_view move(token.begin(), token.end());
+        if (move.empty())
+            continue;
+
+        auto index = GetMoveIndex(move);
+        if (!index.has_value())
+            return false;
+
+        ApplyMove(index.value());
+    }
+
+    return true;
+}
+auto CubieCube::GetInverse() const -> CubieCube
+{
+    CubieCube inverse;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        inverse.CornerPermutation[CornerPermutation[i]] = i;
+        uint8_t orientation = CornerOrientation[i];
+        inverse.CornerOrientation[CornerPermutation[i]] = orientation >= 3 ? orientation : (3 - orientation) % 3;
+    }
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        inverse.EdgePermutation[EdgePermutation[i]] = i;
+        inverse.EdgeOrientation[EdgePermutation[i]] = EdgeOrientation[i];
+    }
+
+    return inverse;
+}
+
+auto CubieCube::GetCornerParity() const -> bool
+{
+    return IsOddPermutation(CornerPermutation);
+}
+auto CubieCube::GetEdgeParity() const -> bool
+{
+    return IsOddPermutation(EdgePermutation);
+}
+
+auto CubieCube::FromCube(const Cube& cube) -> std::optional<CubieCube>
+{
+    uint32_t size = cube.GetSize();
+    if (size != 2 && size != 3)
+        return std::nullopt;
+
+    auto colorsAt = [&cube](const PieceLocation& location) -> const PieceColors& {
+        return cube.GetPieceColors(location).value().get();
+    };
+
+    // which face every color belongs to in the frame the state is read in
+    std::array<Face, 6> colorFaces;
+    colorFaces.fill(Face::None);
+    if (size == 3)
+    {
+        for (Face face : { Face::Top, Face::Front, Face::Right, Face::Back, Face::Left, Face::Bottom })
+        {
+            uint32_t x = face == Face::Left ? 0 : face == Face::Right ? 2 : 1;
+            uint32_t y = face == Face::Bottom ? 0 : face == Face::Top ? 2 : 1;
+            uint32_t z = face == Face::Back ? 0 : face == Face::Front ? 2 : 1;
+            colorFaces[std::to_underlying(colorsAt({ x, y, z })[face])] = face;
+        }
+    }
+    else
+    {
+        // opposite colors are neighbours in FaceColor
+        const PieceColors& corner = colorsAt(GetCornerLocation(DBL, size));
+        for (auto [face, opposite] : { std::pair { Face::Bottom, Face::Top }, { Face::Back, Face::Front }, { Face::Left, Face::Right } })
+        {
+            colorFaces[std::to_underlying(corner[face])] = face;
+            colorFaces[std::to_underlying(corner[face]) ^ 1] = opposite;
+        }
+    }
+    if (std::ranges::find(colorFaces, Face::None) != colorFaces.end())
+        return std::nullopt;
+
+    return ReadPieces(size, [&](const PieceLocation& location, Face face) {
+        FaceColor color = colorsAt(location)[face];
+        return color == FaceColor::None ? Face::None : colorFaces[std::to_underlying(color)];
+    });
+}
+auto CubieCube::FromFacelets(std::string_view facelets) -> std::optional<CubieCube>
+{
+    if (facelets.size() != 54)
+        return std::nullopt;
+
+    // the centers tell which face every letter belongs to
+    std::array<Face, 256> letterFaces;
+    letterFaces.fill(Face::None);
+    for (Face face : { Face::Top, Face::Front, Face::Right, Face::Back, Face::Left, Face::Bottom })
+    {
+        uint32_t x = face == Face::Left ? 0 : face == Face::Right ? 2 : 1;
+        uint32_t y = face == Face::Bottom ? 0 : face == Face::Top ? 2 : 1;
+        uint32_t z = face == Face::Back ? 0 : face == Face::Front ? 2 : 1;
+        letterFaces[(uint8_t)facelets[FaceletString::GetFaceletIndex(3, face, { x, y, z })]] = face;
+    }
+
+    return ReadPieces(3, [&](const PieceLocation& location, Face face) {
+        return letterFaces[(uint8_t)facelets[FaceletString::GetFaceletIndex(3, face, location)]];
+    });
+}
+auto CubieCube::ApplyTo(Cube& cube) const -> void
+{
+    uint32_t size = cube.GetSize() == 2 ? 2 : 3;
+    FaceletString::Import(cube, ToFacelets(size));
+}
+auto CubieCube::ToFacelets(uint32_t size) const -> std::string
+{
+    std::string facelets(6 * size * size, '?');
+    if (size == 3)
+    {
+        for (Face face : { Face::Top, Face::Front, Face::Right, Face::Back, Face::Left, Face::Bottom })
+        {
+            uint32_t x = face == Face::Left ? 0 : face == Face::Right ? 2 : 1;
+            uint32_t y = face == Face::Bottom ? 0 : face == Face::Top ? 2 : 1;
+            uint32_t z = face == Face::Back ? 0 : face == Face::Front ? 2 : 1;
+            facelets[FaceletString::GetFaceletIndex(size, face, { x, y, z })] = FaceToChar(face);
+        }
+    }
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        PieceLocation location = GetCornerLocation(i, size);
+        for (uint32_t k = 0; k < 3; k++)
+        {
+            Face face = s_CornerFaces[i][(k + CornerOrientation[i]) % 3];
+            facelets[FaceletString::GetFaceletIndex(size, face, location)] = FaceToChar(s_CornerFaces[CornerPermutation[i]][k]);
+        }
+    }
+    if (size == 2)
+        return facelets;
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        PieceLocation location = GetEdgeLocation(i);
+        for (uint32_t k = 0; k < 2; k++)
+        {
+            Face face = s_EdgeFaces[i][(k + EdgeOrientation[i]) % 2];
+            facelets[FaceletString::GetFaceletIndex(size, face, location)] = FaceToChar(s_EdgeFaces[EdgePermutation[i]][k]);
+        }
+    }
+
+    return facelets;
+}
+
+auto CubieCube::Solved() -> CubieCube
+{
+    CubieCube cube;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        cube.CornerPermutation[i] = i;
+        cube.CornerOrientation[i] = 0;
+    }
+    for (uint8_t i = 0; i < 12; i++)
+    {
+        cube.EdgePermutation[i] = i;
+        cube.EdgeOrientation[i] = 0;
+    }
+
+    return cube;
+}
+auto CubieCube::GetMove(uint32_t move) -> const CubieCube&
+{
+    static const std::array<CubieCube, MOVE_COUNT> moves = BuildMoves();
+    return moves[move];
+}
+auto CubieCube::GetMoveName(uint32_t move) -> std::string_view
+{
+    return s_MoveNames[move];
+}
+auto CubieCube::GetMoveIndex(std::string_view move) -> std::optional<uint32_t>
+{
+    auto it = std::ranges::find(s_MoveNames, move);
+    if (it == s_MoveNames.end())
+        return std::nullopt;
+
+    return std::distance(s_MoveNames.begin(), it);
+}
+auto CubieCube::FormatMoves(std::span<const uint32_t> moves) -> std::string
+{
+    std::string formatted;
+    for (uint32_t move : moves)
+    {
+        if (!formatted.empty())
+            formatted += ' ';
+        formatted += GetMoveName(move);
+    }
+
+    return formatted;
+}
+auto CubieCube::AppendMove(std::vector<uint32_t>& moves, uint32_t move) -> void
+{
+    if (moves.empty() || moves.back() / 3 != move / 3)
+    {
+        moves.push_back(move);
+        return;
+    }
+
+    // the powers add up, a full turn drops both
+    uint32_t power = (moves.back() % 3 + 1 + move % 3 + 1) % 4;
+    if (power == 0)
+        moves.pop_back();
+    else
+        moves.back() = move / 3 * 3 + power - 1;
+}
+auto CubieCube::ToMove(uint32_t move) -> Move
+{
+    // Move lists the faces in U, F, R, B, L, D order with 5 entries each
+    static constexpr std::array<uint32_t, 6> faceOffsets = { 0, 10, 5, 25, 20, 15 };
+    return (Move)(faceOffsets[move / 3] + move % 3);
+}
+
+auto CubieCube::GetCornerLocation(uint32_t corner, uint32_t size) -> PieceLocation
+{
+    const uint32_t last = size - 1;
+    switch (corner)
+    {
+    case URF:
+        return { last, last, last };
+    case UFL:
+        return { 0, last, last };
+    case ULB:
+        return { 0, last, 0 };
+    case UBR:
+        return { last, last, 0 };
+    case DFR:
+        return { last, 0, last };
+    case DLF:
+        return { 0, 0, last };
+    case DBL:
+        return { 0, 0, 0 };
+    default:
+        return { last, 0, 0 };
+    }
+}
+auto CubieCube::GetEdgeLocation(uint32_t edge) -> PieceLocation
+{
+    static constexpr std::array<PieceLocation, 12> locations = {{
+        { 2, 2, 1 }, { 1, 2, 2 }, { 0, 2, 1 }, { 1, 2, 0 },
+        { 2, 0, 1 }, { 1, 0, 2 }, { 0, 0, 1 }, { 1, 0, 0 },
+        { 2, 1, 2 }, { 0, 1, 2 }, { 0, 1, 0 }, { 2, 1, 0 }
+    }};
+
+    return locations[edge];
+}
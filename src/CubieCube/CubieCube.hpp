@@ -0,0 +1,82 @@
+#ifndef CUBIECUBE_H
+#define CUBIECUBE_H
+
+#include "Cube/Cube.hpp"
+#include "Face/Face.hpp"
+#include "Move/Move.hpp"
+
+#include <array>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Piece level model of the 3x3 (and of the corners of the 2x2) for the search based code:
+// which cubie sits in every slot and how much it is twisted or flipped there.
+struct CubieCube
+{
+    enum Corner : uint8_t { URF = 0, UFL, ULB, UBR, DFR, DLF, DBL, DRB };
+    enum Edge : uint8_t { UR = 0, UF, UL, UB, DR, DF, DL, DB, FR, FL, BL, BR };
+
+    // the 18 face turns in U, U2, U', R, R2, R', F, .., D, .., L, .., B, .. order
+    static constexpr uint32_t MOVE_COUNT = 18;
+
+    std::array<uint8_t, 8> CornerPermutation;
+    std::array<uint8_t, 8> CornerOrientation;
+    std::array<uint8_t, 12> EdgePermutation;
+    std::array<uint8_t, 12> EdgeOrientation;
+
+    auto operator==(const CubieCube& other) const -> bool = default;
+
+    // this = this * other, i.e. other's permutation is applied after this one
+    auto Multiply(const CubieCube& other) -> void;
+    auto ApplyMove(uint32_t move) -> void;
+    auto ApplyMoves(std::string_view moves) -> bool;
+    auto GetInverse() const -> CubieCube;
+
+    auto GetCornerParity() const -> bool;
+    auto GetEdgeParity() const -> bool;
+
+    // the stickers are read relative to the centers (3x3) or to the DBL corner (2x2), so the DBL corner of
+    // a 2x2 is always solved and the centers of a 3x3 never move
+    static auto FromCube(const Cube& cube) -> std::optional<CubieCube>;
+    // a 3x3 facelet string read relative to its centers
+    static auto FromFacelets(std::string_view facelets) -> std::optional<CubieCube>;
+    auto ApplyTo(Cube& cube) const -> void;
+    auto ToFacelets(uint32_t size) const -> std::string;
+
+    static auto Solved() -> CubieCube;
+    static auto GetMove(uint32_t move) -> const CubieCube&;
+    static auto GetMoveName(uint32_t move) -> std::string_view;
+    static auto GetMoveIndex(std::string_view move) -> std::optional<uint32_t>;
+    static auto FormatMoves(std::span<const uint32_t> moves) -> std::string;
+    // appends the move, merged with the last one when they turn the same face
+    static auto AppendMove(std::vector<uint32_t>& moves, uint32_t move) -> void;
+    static auto ToMove(uint32_t move) -> Move;
+
+    // the twist of a corner after two twists, 3..5 being the twists of the mirrored corners that only
+    // appear in the reflection symmetries
+    static constexpr auto s_OrientationProducts = [] {
+        std::array<std::array<uint8_t, 6>, 6> products;
+        for (uint8_t a = 0; a < 6; a++)
+        {
+            for (uint8_t b = 0; b < 6; b++)
+            {
+                if (a < 3)
+                    products[a][b] = (a + b % 3) % 3 + (b >= 3 ? 3 : 0);
+                else
+                    products[a][b] = (a + 3 - b % 3) % 3 + (b >= 3 ? 0 : 3);
+            }
+        }
+
+        return products;
+    }();
+
+    static const std::array<std::array<Face, 3>, 8> s_CornerFaces;
+    static const std::array<std::array<Face, 2>, 12> s_EdgeFaces;
+    static auto GetCornerLocation(uint32_t corner, uint32_t size) -> PieceLocation;
+    static auto GetEdgeLocation(uint32_t edge) -> PieceLocation;
+};
+
+#endif
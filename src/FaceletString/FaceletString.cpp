@@ -0,0 +1,507 @@
+#include "FaceletString.hpp"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using Normal = std::array<int32_t, 3>;
+
+static constexpr std::array<Face, 6> s_HomeFaces = {
+    Face::Top,    // white
+    Face::Bottom, // yellow
+    Face::Front,  // green
+    Face::Back,   // blue
+    Face::Right,  // red
+    Face::Left    // orange
+};
+
+static auto GetNormal(Face face) -> Normal
+{
+    switch (face)
+    {
+    case Face::Top:
+        return { 0, 1, 0 };
+    case Face::Front:
+        return { 0, 0, 1 };
+    case Face::Right:
+        return { 1, 0, 0 };
+    case Face::Back:
+        return { 0, 0, -1 };
+    case Face::Left:
+        return { -1, 0, 0 };
+    case Face::Bottom:
+        return { 0, -1, 0 };
+    case Face::None:
+        break;
+    }
+
+    std::unreachable();
+}
+static auto GetHomeNormal(FaceColor color) -> Normal
+{
+    return GetNormal(s_HomeFaces[std::to_underlying(color)]);
+}
+static auto GetAxis(const Normal& normal) -> uint32_t
+{
+    return normal[0] != 0 ? 0 : (normal[1] != 0 ? 1 : 2);
+}
+static auto Determinant(const Normal& a, const Normal& b, const Normal& c) -> int32_t
+{
+    return a[0] * (b[1] * c[2] - b[2] * c[1])
+         - a[1] * (b[0] * c[2] - b[2] * c[0])
+         + a[2] * (b[0] * c[1] - b[1] * c[0]);
+}
+static auto Cross(const Normal& a, const Normal& b) -> Normal
+{
+    return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+static auto IsOddPermutation(std::vector<uint32_t> permutation) -> bool
+{
+    // every cycle of length k takes k - 1 transpositions
+    bool odd = false;
+    for (uint32_t i = 0; i < permutation.size(); i++)
+    {
+        while (permutation[i] != i)
+        {
+            std::swap(permutation[i], permutation[permutation[i]]);
+            odd = !odd;
+        }
+    }
+
+    return odd;
+}
+
+static auto GetFaceLocation(uint32_t size, Face face, uint32_t a, uint32_t b) -> PieceLocation
+{
+    // the face fixes one coordinate, the other two are walked
+    Normal normal = GetNormal(face);
+    uint32_t axis = GetAxis(normal);
+
+    std::array<uint32_t, 3> coordinates;
+    coordinates[axis] = normal[axis] > 0 ? size - 1 : 0;
+    coordinates[(axis + 1) % 3] = a;
+    coordinates[(axis + 2) % 3] = b;
+
+    return { coordinates[0], coordinates[1], coordinates[2] };
+}
+
+auto FaceletString::Export(const Cube& cube) -> std::string
+{
+    uint32_t size = cube.GetSize();
+    std::string facelets(6 * size * size, ' ');
+
+    for (Face face : s_FaceOrder)
+    {
+        for (uint32_t a = 0; a < size; a++)
+        {
+            for (uint32_t b = 0; b < size; b++)
+            {
+                PieceLocation location = GetFaceLocation(size, face, a, b);
+                FaceColor color = cube.GetPieceColors(location).value().get()[face];
+                facelets[GetFaceletIndex(size, face, location)] = ColorToChar(color);
+            }
+        }
+    }
+
+    return facelets;
+}
+auto FaceletString::Import(Cube& cube, std::string_view facelets) -> Validity
+{
+    Validity validity = Validate(facelets);
+    if (validity != Validity::VALID)
+        return validity;
+
+    uint32_t size = GetSize(facelets);
+    std::vector<PieceColors> pieceColors(size * size * size);
+    for (Face face : s_FaceOrder)
+    {
+        for (uint32_t a = 0; a < size; a++)
+        {
+            for (uint32_t b = 0; b < size; b++)
+            {
+                PieceLocation location = GetFaceLocation(size, face, a, b);
+                uint32_t index = location.Z * size * size + location.Y * size + location.X;
+                pieceColors[index][face] = CharToColor(facelets[GetFaceletIndex(size, face, location)]);
+            }
+        }
+    }
+
+    if (cube.GetSize() != size)
+        cube.SetSize(size);
+    cube.LoadPieceColors(pieceColors);
+
+    return Validity::VALID;
+}
+
+auto FaceletString::Validate(std::string_view facelets) -> Validity
+{
+    uint32_t size = GetSize(facelets);
+    if (size == 0)
+        return Validity::INVALID_LENGTH;
+
+    // every color must appear on exactly N^2 facelets
+    std::array<uint32_t, 6> colorCounts { };
+    for (char facelet : facelets)
+    {
+        FaceColor color = CharToColor(facelet);
+        if (color == FaceColor::None)
+            return Validity::INVALID_CHARACTER;
+
+        colorCounts[std::to_underlying(color)]++;
+    }
+    for (uint32_t count : colorCounts)
+        if (count != size * size)
+            return Validity::INVALID_COLOR_COUNT;
+
+    Validity validity;
+    bool cornerParity = false, edgeParity = false, centerParity = false;
+
+    if ((validity = _ValidateCenters(facelets, size, centerParity)) != Validity::VALID)
+        return validity;
+    if ((validity = _ValidateCorners(facelets, size, cornerParity)) != Validity::VALID)
+        return validity;
+    if ((validity = _ValidateEdges(facelets, size, edgeParity)) != Validity::VALID)
+        return validity;
+
+    // on odd cubes the corners, the middle edges and the fixed centers are bound together, on even cubes
+    // the indistinguishable centers absorb every parity
+    if (size % 2 == 1 && (cornerParity != edgeParity) != centerParity)
+        return Validity::PARITY;
+
+    return Validity::VALID;
+}
+
+auto FaceletString::GetSize(std::string_view facelets) -> uint32_t
+{
+    if (facelets.size() % 6 != 0)
+        return 0;
+
+    uint32_t size = static_cast<uint32_t>(std::lround(std::sqrt(facelets.size() / 6.0)));
+    return size >= 2 && 6 * size * size == facelets.size() ? size : 0;
+}
+auto FaceletString::GetFaceletIndex(uint32_t size, Face face, const PieceLocation& location) -> uint32_t
+{
+    const uint32_t last = size - 1;
+    uint32_t row, col;
+
+    switch (face)
+    {
+    case Face::Top:
+        row = location.Z;
+        col = location.X;
+        break;
+    case Face::Right:
+        row = last - location.Y;
+        col = last - location.Z;
+        break;
+    case Face::Front:
+        row = last - location.Y;
+        col = location.X;
+        break;
+    case Face::Bottom:
+        row = last - location.Z;
+        col = location.X;
+        break;
+    case Face::Left:
+        row = last - location.Y;
+        col = location.Z;
+        break;
+    case Face::Back:
+        row = last - location.Y;
+        col = last - location.X;
+        break;
+
+    default:
+        std::unreachable();
+    }
+
+    uint32_t slot = static_cast<uint32_t>(std::ranges::find(s_FaceOrder, face) - s_FaceOrder.begin());
+    return slot * size * size + row * size + col;
+}
+
+auto FaceletString::GetValidityName(Validity validity) -> std::string_view
+{
+    switch (validity)
+    {
+    case Validity::VALID:
+        return "VALID";
+    case Validity::INVALID_LENGTH:
+        return "INVALID LENGTH";
+    case Validity::INVALID_CHARACTER:
+        return "INVALID CHARACTER";
+    case Validity::INVALID_COLOR_COUNT:
+        return "INVALID COLOR COUNT";
+    case Validity::INVALID_CENTERS:
+        return "INVALID CENTERS";
+    case Validity::INVALID_CORNERS:
+        return "INVALID CORNERS";
+    case Validity::INVALID_EDGES:
+        return "INVALID EDGES";
+    case Validity::TWISTED_CORNER:
+        return "TWISTED CORNER";
+    case Validity::FLIPPED_EDGE:
+        return "FLIPPED EDGE";
+    case Validity::PARITY:
+        return "PARITY";
+    }
+
+    std::unreachable();
+}
+
+auto FaceletString::ColorToChar(FaceColor color) -> char
+{
+    switch (color)
+    {
+    case FaceColor::White:
+        return 'U';
+    case FaceColor::Yellow:
+        return 'D';
+    case FaceColor::Green:
+        return 'F';
+    case FaceColor::Blue:
+        return 'B';
+    case FaceColor::Red:
+        return 'R';
+    case FaceColor::Orange:
+        return 'L';
+    case FaceColor::None:
+        return '?';
+    }
+
+    std::unreachable();
+}
+auto FaceletString::CharToColor(char facelet) -> FaceColor
+{
+    switch (facelet)
+    {
+    case 'U':
+        return FaceColor::White;
+    case 'D':
+        return FaceColor::Yellow;
+    case 'F':
+        return FaceColor::Green;
+    case 'B':
+        return FaceColor::Blue;
+    case 'R':
+        return FaceColor::Red;
+    case 'L':
+        return FaceColor::Orange;
+
+    default:
+        return FaceColor::None;
+    }
+}
+
+auto FaceletString::_ValidateCorners(std::string_view facelets, uint32_t size, bool& cornerParity) -> Validity
+{
+    const uint32_t last = size - 1;
+    auto getColor = [&](Face face, const PieceLocation& location) {
+        return CharToColor(facelets[GetFaceletIndex(size, face, location)]);
+    };
+
+    std::vector<uint32_t> permutation(8);
+    uint32_t seen = 0;
+    uint32_t twist = 0;
+    for (uint32_t slot = 0; slot < 8; slot++)
+    {
+        PieceLocation location { slot & 2 ? last : 0, slot & 1 ? last : 0, slot & 4 ? last : 0 };
+
+        // list the faces clockwise starting from the top or bottom one
+        std::array<Face, 3> faces {
+            slot & 1 ? Face::Top : Face::Bottom,
+            slot & 2 ? Face::Right : Face::Left,
+            slot & 4 ? Face::Front : Face::Back
+        };
+        if (Determinant(GetNormal(faces[0]), GetNormal(faces[1]), GetNormal(faces[2])) > 0)
+            std::swap(faces[1], faces[2]);
+
+        std::array<FaceColor, 3> colors { getColor(faces[0], location), getColor(faces[1], location), getColor(faces[2], location) };
+        std::array<Normal, 3> homeNormals { GetHomeNormal(colors[0]), GetHomeNormal(colors[1]), GetHomeNormal(colors[2]) };
+
+        // the colors must come from the three different axes, in the same handedness as on the solved cube
+        if (Determinant(homeNormals[0], homeNormals[1], homeNormals[2]) != Determinant(GetNormal(faces[0]), GetNormal(faces[1]), GetNormal(faces[2])))
+            return Validity::INVALID_CORNERS;
+
+        uint32_t corner = 0;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            const Normal& normal = homeNormals[i];
+            if (normal[1] != 0)
+            {
+                corner |= normal[1] > 0 ? 1 : 0;
+                twist += i;
+            }
+            else if (normal[0] > 0 || normal[2] > 0)
+                corner |= normal[0] > 0 ? 2 : 4;
+        }
+
+        if (seen & (1 << corner))
+            return Validity::INVALID_CORNERS;
+
+        seen |= 1 << corner;
+        permutation[slot] = corner;
+    }
+
+    if (twist % 3 != 0)
+        return Validity::TWISTED_CORNER;
+
+    cornerParity = IsOddPermutation(permutation);
+    return Validity::VALID;
+}
+auto FaceletString::_ValidateEdges(std::string_view facelets, uint32_t size, bool& edgeParity) -> Validity
+{
+    const uint32_t last = size - 1;
+    auto getColor = [&](Face face, const PieceLocation& location) {
+        return CharToColor(facelets[GetFaceletIndex(size, face, location)]);
+    };
+    // the 12 edges are the unordered pairs of faces from different axes
+    auto getEdgeIndex = [](Face a, Face b) {
+        uint32_t mask = (1 << std::to_underlying(a)) | (1 << std::to_underlying(b));
+        uint32_t index = 0;
+        for (uint32_t i = 0; i < 6; i++)
+            for (uint32_t j = i + 1; j < 6; j++)
+                if (GetAxis(GetNormal(static_cast<Face>(i))) != GetAxis(GetNormal(static_cast<Face>(j))))
+                {
+                    if (mask == ((1u << i) | (1u << j)))
+                        return index;
+                    index++;
+                }
+
+        std::unreachable();
+    };
+
+    // the wings of an orbit carry the 24 distinct ordered color pairs
+    std::vector<uint64_t> wingsSeen((size - 2) / 2, 0);
+    std::vector<uint32_t> permutation(12);
+    uint32_t midgesSeen = 0;
+    uint32_t flip = 0;
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        for (uint32_t corner = 0; corner < 4; corner++)
+        {
+            for (uint32_t t = 1; t < last; t++)
+            {
+                // the two coordinates besides the edge's axis sit on the boundary
+                std::array<uint32_t, 3> coordinates;
+                coordinates[axis] = t;
+                coordinates[(axis + 1) % 3] = corner & 1 ? last : 0;
+                coordinates[(axis + 2) % 3] = corner & 2 ? last : 0;
+                PieceLocation location { coordinates[0], coordinates[1], coordinates[2] };
+
+                std::array<Face, 2> faces;
+                for (uint32_t i = 0; i < 2; i++)
+                {
+                    uint32_t faceAxis = (axis + 1 + i) % 3;
+                    bool positive = coordinates[faceAxis] == last;
+                    faces[i] = faceAxis == 0 ? (positive ? Face::Right : Face::Left)
+                             : faceAxis == 1 ? (positive ? Face::Top : Face::Bottom)
+                             : (positive ? Face::Front : Face::Back);
+                }
+
+                std::array<FaceColor, 2> colors { getColor(faces[0], location), getColor(faces[1], location) };
+                std::array<Normal, 2> homeNormals { GetHomeNormal(colors[0]), GetHomeNormal(colors[1]) };
+                if (GetAxis(homeNormals[0]) == GetAxis(homeNormals[1]))
+                    return Validity::INVALID_EDGES;
+
+                Face homeFaceA = s_HomeFaces[std::to_underlying(colors[0])];
+                Face homeFaceB = s_HomeFaces[std::to_underlying(colors[1])];
+
+                // middle edge of an odd cube, it can be flipped
+                if (2 * t == last)
+                {
+                    uint32_t edge = getEdgeIndex(homeFaceA, homeFaceB);
+                    if (midgesSeen & (1 << edge))
+                        return Validity::INVALID_EDGES;
+
+                    midgesSeen |= 1 << edge;
+                    permutation[getEdgeIndex(faces[0], faces[1])] = edge;
+
+                    // the reference face is the top/bottom one, or the front/back one on the middle layer,
+                    // the reference color is white/yellow, or green/blue if the edge has neither
+                    Face referenceFace = GetAxis(GetNormal(faces[0])) == 1 || (GetAxis(GetNormal(faces[1])) != 1 && GetAxis(GetNormal(faces[0])) == 2) ? faces[0] : faces[1];
+                    uint32_t referenceColor = GetAxis(homeNormals[0]) == 1 || (GetAxis(homeNormals[1]) != 1 && GetAxis(homeNormals[0]) == 2) ? 0 : 1;
+                    flip += faces[referenceColor] != referenceFace;
+                    continue;
+                }
+
+                // a wing can't be flipped, its colors always follow the same handedness along the edge
+                Normal direction { 0, 0, 0 };
+                direction[axis] = 2 * t < last ? -1 : 1;
+                Normal cross = Cross(GetNormal(faces[0]), GetNormal(faces[1]));
+                bool ordered = cross[0] * direction[0] + cross[1] * direction[1] + cross[2] * direction[2] > 0;
+                uint32_t wing = ordered
+                    ? std::to_underlying(homeFaceA) * 6 + std::to_underlying(homeFaceB)
+                    : std::to_underlying(homeFaceB) * 6 + std::to_underlying(homeFaceA);
+
+                uint64_t& seen = wingsSeen[std::min(t, last - t) - 1];
+                if (seen & (1ull << wing))
+                    return Validity::INVALID_EDGES;
+
+                seen |= 1ull << wing;
+            }
+        }
+    }
+
+    if (flip % 2 != 0)
+        return Validity::FLIPPED_EDGE;
+
+    edgeParity = size % 2 == 1 && IsOddPermutation(permutation);
+    return Validity::VALID;
+}
+auto FaceletString::_ValidateCenters(std::string_view facelets, uint32_t size, bool& centerParity) -> Validity
+{
+    const uint32_t last = size - 1;
+    const uint32_t faceSize = size * size;
+
+    // a center can only travel between the 4 rotations of its position on any face, each orbit of 24 holds 4 of every color
+    std::vector<std::array<uint8_t, 6>> orbitColorCounts(faceSize, std::array<uint8_t, 6>{ });
+    for (uint32_t slot = 0; slot < 6; slot++)
+    {
+        for (uint32_t row = 1; row < last; row++)
+        {
+            for (uint32_t col = 1; col < last; col++)
+            {
+                if (2 * row == last && 2 * col == last)
+                    continue;
+
+                uint32_t orbit = std::min({
+                    row * size + col,
+                    col * size + last - row,
+                    (last - row) * size + last - col,
+                    (last - col) * size + row
+                });
+                FaceColor color = CharToColor(facelets[slot * faceSize + row * size + col]);
+                if (++orbitColorCounts[orbit][std::to_underlying(color)] > 4)
+                    return Validity::INVALID_CENTERS;
+            }
+        }
+    }
+
+    centerParity = false;
+    if (size % 2 == 0)
+        return Validity::VALID;
+
+    // the fixed centers of odd cubes must be a rotation of the solved ones
+    uint32_t middle = last / 2 * size + last / 2;
+    std::vector<uint32_t> permutation(6);
+    std::array<Normal, 6> homeNormals;
+    for (uint32_t slot = 0; slot < 6; slot++)
+    {
+        FaceColor color = CharToColor(facelets[slot * faceSize + middle]);
+        homeNormals[slot] = GetHomeNormal(color);
+        permutation[std::to_underlying(s_FaceOrder[slot])] = std::to_underlying(s_HomeFaces[std::to_underlying(color)]);
+    }
+    for (uint32_t slot = 0; slot < 3; slot++)
+    {
+        const Normal& opposite = homeNormals[slot + 3];
+        if (homeNormals[slot][0] != -opposite[0] || homeNormals[slot][1] != -opposite[1] || homeNormals[slot][2] != -opposite[2])
+            return Validity::INVALID_CENTERS;
+    }
+
+    // U, R, F have to keep the handedness of the solved cube
+    if (Determinant(homeNormals[0], homeNormals[1], homeNormals[2]) != Determinant(GetNormal(Face::Top), GetNormal(Face::Right), GetNormal(Face::Front)))
+        return Validity::INVALID_CENTERS;
+
+    centerParity = IsOddPermutation(permutation);
+    return Validity::VALID;
+}
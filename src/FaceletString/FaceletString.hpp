@@ -0,0 +1,61 @@
+#ifndef FACELETSTRING_H
+#define FACELETSTRING_H
+
+#include "Cube/Cube.hpp"
+#include "Face/Face.hpp"
+#include "Face/FaceColor.hpp"
+#include "Piece/PieceLocation.hpp"
+
+#include <array>
+#include <string>
+#include <string_view>
+
+// Converts between cubes and facelet strings: the faces in U, R, F, D, L, B order, each face
+// row by row as seen from the outside (the standard layout of 3x3 tools, generalized to NxN).
+// Every facelet is the letter of the face its color belongs to on the solved cube.
+class FaceletString
+{
+public:
+    enum class Validity
+    {
+        VALID = 0,
+        INVALID_LENGTH,
+        INVALID_CHARACTER,
+        INVALID_COLOR_COUNT,
+        INVALID_CENTERS,
+        INVALID_CORNERS,
+        INVALID_EDGES,
+        TWISTED_CORNER,
+        FLIPPED_EDGE,
+        PARITY
+    };
+
+public:
+    static auto Export(const Cube& cube) -> std::string;
+    static auto Import(Cube& cube, std::string_view facelets) -> Validity;
+
+    // checks in O(N^2) whether the state can be reached from the solved cube
+    static auto Validate(std::string_view facelets) -> Validity;
+
+    // the edge length of the cube described by the string, 0 if the length is not 6 * N^2
+    static auto GetSize(std::string_view facelets) -> uint32_t;
+    static auto GetFaceletIndex(uint32_t size, Face face, const PieceLocation& location) -> uint32_t;
+
+    // upper case, for the user
+    static auto GetValidityName(Validity validity) -> std::string_view;
+
+    static auto ColorToChar(FaceColor color) -> char;
+    static auto CharToColor(char facelet) -> FaceColor;
+
+private:
+    static constexpr std::array<Face, 6> s_FaceOrder = {
+        Face::Top, Face::Right, Face::Front, Face::Bottom, Face::Left, Face::Back
+    };
+
+private:
+    static auto _ValidateCorners(std::string_view facelets, uint32_t size, bool& cornerParity) -> Validity;
+    static auto _ValidateEdges(std::string_view facelets, uint32_t size, bool& edgeParity) -> Validity;
+    static auto _ValidateCenters(std::string_view facelets, uint32_t size, bool& centerParity) -> Validity;
+};
+
+#endif
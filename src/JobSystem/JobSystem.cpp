@@ -0,0 +1,134 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+// the queue of the worker running on this thread, if any
+static thread_local const JobSystem* s_CurrentSystem = nullptr;
+static thread_local uint32_t s_CurrentQueue = 0;
+
+JobSystem::JobSystem(uint32_t workerCount)
+    : m_QueuedJobs(0), m_NextQueue(0)
+{
+    for (uint32_t i = 0; i <= workerCount; i++)
+        m_Queues.push_back(std::make_unique<JobQueue>());
+
+    m_Workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+        m_Workers.emplace_back([this, i](std::stop_token stopToken) { _WorkerLoop(stopToken, i); });
+}
+JobSystem::~JobSystem()
+{
+    // join the workers while the queues and the condition variable they use are still alive
+    m_Workers.clear();
+}
+
+auto JobSystem::Get() -> JobSystem&
+{
+    static JobSystem jobSystem(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return jobSystem;
+}
+
+auto JobSystem::ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& job) -> void
+{
+    if (begin >= end)
+        return;
+
+    // a few chunks per thread, so the ones finishing early have something left to steal
+    uint32_t count = end - begin;
+    uint32_t maxChunks = (GetWorkerCount() + 1) * 4;
+    uint32_t chunks = std::min((count + std::max(grainSize, 1u) - 1) / std::max(grainSize, 1u), maxChunks);
+    if (GetWorkerCount() == 0 || chunks <= 1)
+    {
+        job(begin, end);
+        return;
+    }
+
+    uint32_t chunkSize = (count + chunks - 1) / chunks;
+    chunks = (count + chunkSize - 1) / chunkSize;
+
+    std::atomic<uint32_t> pending = chunks - 1;
+    uint32_t ownQueue = s_CurrentSystem == this ? s_CurrentQueue : GetWorkerCount();
+    for (uint32_t chunk = 1; chunk < chunks; chunk++)
+    {
+        uint32_t chunkBegin = begin + chunk * chunkSize;
+        uint32_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+        uint32_t queue = m_NextQueue.fetch_add(1, std::memory_order_relaxed) % m_Queues.size();
+        _Push(queue, { [&job, chunkBegin, chunkEnd] { job(chunkBegin, chunkEnd); }, &pending });
+    }
+
+    {
+        std::lock_guard lock(m_WakeMutex);
+    }
+    m_WakeCondition.notify_all();
+
+    job(begin, std::min(begin + chunkSize, end));
+
+    // help with whatever is queued until the own chunks are done
+    Job other;
+    while (pending.load(std::memory_order_acquire) != 0)
+    {
+        if (_TryPop(ownQueue, other) || _TrySteal(ownQueue, other))
+            _Run(other);
+        else
+            std::this_thread::yield();
+    }
+}
+
+auto JobSystem::_Push(uint32_t queue, Job job) -> void
+{
+    std::lock_guard lock(m_Queues[queue]->Mutex);
+    m_Queues[queue]->Jobs.push_back(std::move(job));
+    m_QueuedJobs.fetch_add(1, std::memory_order_release);
+}
+auto JobSystem::_TryPop(uint32_t queue, Job& job) -> bool
+{
+    std::lock_guard lock(m_Queues[queue]->Mutex);
+    if (m_Queues[queue]->Jobs.empty())
+        return false;
+
+    job = std::move(m_Queues[queue]->Jobs.back());
+    m_Queues[queue]->Jobs.pop_back();
+    m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+auto JobSystem::_TrySteal(uint32_t thief, Job& job) -> bool
+{
+    for (uint32_t i = 1; i < m_Queues.size(); i++)
+    {
+        auto& queue = *m_Queues[(thief + i) % m_Queues.size()];
+
+        std::lock_guard lock(queue.Mutex);
+        if (queue.Jobs.empty())
+            continue;
+
+        job = std::move(queue.Jobs.front());
+        queue.Jobs.pop_front();
+        m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    return false;
+}
+auto JobSystem::_Run(Job& job) -> void
+{
+    job.Task();
+    job.Pending->fetch_sub(1, std::memory_order_release);
+}
+auto JobSystem::_WorkerLoop(std::stop_token stopToken, uint32_t index) -> void
+{
+    s_CurrentSystem = this;
+    s_CurrentQueue = index;
+
+    Job job;
+    while (!stopToken.stop_requested())
+    {
+        if (_TryPop(index, job) || _TrySteal(index, job))
+        {
+            _Run(job);
+            continue;
+        }
+
+        std::unique_lock lock(m_WakeMutex);
+        m_WakeCondition.wait(lock, stopToken, [this] { return m_QueuedJobs.load(std::memory_order_acquire) != 0; });
+    }
+}
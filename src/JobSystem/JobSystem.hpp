@@ -0,0 +1,63 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A small work-stealing thread pool. Every worker pops jobs from the back of its own queue and steals
+// from the front of the others' when it runs dry; a thread waiting for its jobs helps running them.
+class JobSystem
+{
+public:
+    explicit JobSystem(uint32_t workerCount);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    auto operator=(const JobSystem&) -> JobSystem& = delete;
+
+    // the shared pool with a worker for every core but the calling one, started on first use
+    static auto Get() -> JobSystem&;
+
+    // calls job(begin, end) for subranges of at least grainSize elements and returns once all of them are done
+    auto ParallelFor(uint32_t begin, uint32_t end, uint32_t grainSize, const std::function<void(uint32_t, uint32_t)>& job) -> void;
+
+    inline auto GetWorkerCount() const -> uint32_t { return m_Workers.size(); }
+
+private:
+    struct Job
+    {
+        std::function<void()> Task;
+        std::atomic<uint32_t>* Pending;
+    };
+
+    struct JobQueue
+    {
+        std::mutex Mutex;
+        std::deque<Job> Jobs;
+    };
+
+private:
+    auto _Push(uint32_t queue, Job job) -> void;
+    auto _TryPop(uint32_t queue, Job& job) -> bool;
+    auto _TrySteal(uint32_t thief, Job& job) -> bool;
+    auto _Run(Job& job) -> void;
+    auto _WorkerLoop(std::stop_token stopToken, uint32_t index) -> void;
+
+private:
+    // a queue per worker and a last one for the threads outside the pool
+    std::vector<std::unique_ptr<JobQueue>> m_Queues;
+    std::vector<std::jthread> m_Workers;
+
+    std::atomic<uint32_t> m_QueuedJobs;
+    std::atomic<uint32_t> m_NextQueue;
+    std::mutex m_WakeMutex;
+    std::condition_variable_any m_WakeCondition;
+};
+
+#endif
@@ -0,0 +1,306 @@
+#include "LastLayerSolver.hpp"
+
+#include "JobSystem/JobSystem.hpp"
+#include "TwoPhaseSolver/TwoPhaseSolver.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+
+static constexpr std::string_view TABLE_NAME = "last_layer";
+
+// the lehmer code of a permutation of 0..3, swapping the last two pieces toggles its lowest bit
+static auto GetPermutationRank(std::span<const uint8_t> permutation) -> uint32_t
+{
+    uint32_t rank = 0;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t smaller = 0;
+        for (uint32_t j = i + 1; j < 4; j++)
+            smaller += permutation[j] < permutation[i];
+
+        rank = rank * (4 - i) + smaller;
+    }
+
+    return rank;
+}
+static auto SetPermutation(std::span<uint8_t> permutation, uint32_t rank) -> void
+{
+    std::array<uint8_t, 4> pieces = { 0, 1, 2, 3 };
+    std::array<uint32_t, 3> digits = { rank / 6, rank / 2 % 3, rank % 2 };
+
+    uint32_t left = 4;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        uint32_t digit = i < 3 ? digits[i] : 0;
+        permutation[i] = pieces[digit];
+        std::copy(pieces.begin() + digit + 1, pieces.begin() + left, pieces.begin() + digit);
+        left--;
+    }
+}
+static auto GetPermutationParity(uint32_t rank) -> bool
+{
+    return (rank / 6 + rank / 2 % 3 + rank % 2) % 2 == 1;
+}
+
+static auto GetNibble(std::span<const uint8_t> nibbles, uint32_t index) -> uint8_t
+{
+    return (nibbles[index >> 1] >> ((index & 1) * 4)) & 0xF;
+}
+static auto PushNibble(std::vector<uint8_t>& nibbles, uint32_t& count, uint8_t nibble) -> void
+{
+    if ((count & 1) == 0)
+        nibbles.push_back(nibble);
+    else
+        nibbles.back() |= nibble << 4;
+
+    count++;
+}
+
+auto LastLayerSolver::Solve(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>
+{
+    const Tables* tables = GetTables();
+    if (tables == nullptr)
+        return std::nullopt;
+
+    auto lastLayerCase = GetCase(cube);
+    if (!lastLayerCase.has_value())
+        return std::nullopt;
+
+    auto [rank, turns] = lastLayerCase.value();
+    auto it = std::lower_bound(tables->Ranks.begin(), tables->Ranks.end(), rank);
+    if (it == tables->Ranks.end() || *it != rank)
+        return std::nullopt;
+
+    std::vector<uint32_t> moves;
+    if (turns > 0)
+        moves.push_back(turns - 1);
+
+    size_t index = it - tables->Ranks.begin();
+    uint32_t begin = tables->Offsets[index];
+    uint32_t end = tables->Offsets[index + 1];
+    if (begin == end)
+        return moves;
+
+    uint32_t face = GetNibble(tables->Solutions, begin);
+    CubieCube::AppendMove(moves, face * 3 + GetNibble(tables->Solutions, begin + 1));
+    for (uint32_t i = begin + 2; i < end; i++)
+    {
+        uint8_t nibble = GetNibble(tables->Solutions, i);
+        face = (face + nibble / 3 + 1) % 6;
+        CubieCube::AppendMove(moves, face * 3 + nibble % 3);
+    }
+
+    return moves;
+}
+
+auto LastLayerSolver::GetTables() -> const Tables*
+{
+    static const std::optional<Tables> tables = []() -> std::optional<Tables> {
+        auto table = TableStore::Open(TABLE_NAME, TABLE_VERSION);
+        if (!table.has_value())
+            return std::nullopt;
+
+        return _ReadTables(std::move(table.value()));
+    }();
+
+    return tables.has_value() ? &tables.value() : nullptr;
+}
+auto LastLayerSolver::GenerateTables(const std::function<void(float)>& progress) -> bool
+{
+    // a failed build is empty and leaves no file behind, the next run builds again
+    if (TableStore::Load(TABLE_NAME, TABLE_VERSION, [&progress] { return _BuildTables(progress); }).GetBytes().empty())
+        return false;
+
+    auto table = TableStore::Open(TABLE_NAME, TABLE_VERSION);
+    return table.has_value() && _ReadTables(std::move(table.value())).has_value();
+}
+
+auto LastLayerSolver::GetRank(const CubieCube& cube) -> std::optional<uint32_t>
+{
+    for (uint32_t i = 4; i < 8; i++)
+    {
+        if (cube.CornerPermutation[i] != i || cube.CornerOrientation[i] != 0)
+            return std::nullopt;
+    }
+    for (uint32_t i = 4; i < 12; i++)
+    {
+        if (cube.EdgePermutation[i] != i || cube.EdgeOrientation[i] != 0)
+            return std::nullopt;
+    }
+
+    uint32_t twist = 0;
+    uint32_t flip = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        twist = twist * 3 + cube.CornerOrientation[i];
+        flip = flip * 2 + cube.EdgeOrientation[i];
+    }
+
+    uint32_t cornerPermutation = GetPermutationRank(std::span(cube.CornerPermutation).first(4));
+    uint32_t edgePermutation = GetPermutationRank(std::span(cube.EdgePermutation).first(4));
+    return ((cornerPermutation * CORNER_TWISTS + twist) * EDGE_PERMUTATIONS + edgePermutation / 2) * EDGE_FLIPS + flip;
+}
+auto LastLayerSolver::GetCube(uint32_t rank) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+
+    uint32_t flip = rank % EDGE_FLIPS;
+    rank /= EDGE_FLIPS;
+    uint32_t edgePermutation = rank % EDGE_PERMUTATIONS * 2;
+    rank /= EDGE_PERMUTATIONS;
+    uint32_t twist = rank % CORNER_TWISTS;
+    uint32_t cornerPermutation = rank / CORNER_TWISTS;
+
+    // the edge permutation of the other parity is one swap away
+    if (GetPermutationParity(edgePermutation) != GetPermutationParity(cornerPermutation))
+        edgePermutation++;
+
+    SetPermutation(std::span(cube.CornerPermutation).first(4), cornerPermutation);
+    SetPermutation(std::span(cube.EdgePermutation).first(4), edgePermutation);
+
+    uint32_t twistSum = 0;
+    uint32_t flipSum = 0;
+    for (int32_t i = 2; i >= 0; i--)
+    {
+        cube.CornerOrientation[i] = twist % 3;
+        cube.EdgeOrientation[i] = flip % 2;
+        twistSum += twist % 3;
+        flipSum += flip % 2;
+        twist /= 3;
+        flip /= 2;
+    }
+    cube.CornerOrientation[3] = (3 - twistSum % 3) % 3;
+    cube.EdgeOrientation[3] = flipSum % 2;
+
+    return cube;
+}
+auto LastLayerSolver::GetCase(const CubieCube& cube) -> std::optional<std::pair<uint32_t, uint32_t>>
+{
+    auto rank = GetRank(cube);
+    if (!rank.has_value())
+        return std::nullopt;
+
+    std::pair<uint32_t, uint32_t> lastLayerCase = { rank.value(), 0 };
+    CubieCube turned = cube;
+    for (uint32_t turns = 1; turns < 4; turns++)
+    {
+        turned.ApplyMove(0);
+        uint32_t turnedRank = GetRank(turned).value();
+        if (turnedRank < lastLayerCase.first)
+            lastLayerCase = { turnedRank, turns };
+    }
+
+    return lastLayerCase;
+}
+
+auto LastLayerSolver::_BuildTables(const std::function<void(float)>& progress) -> std::vector<uint8_t>
+{
+    std::vector<uint16_t> ranks;
+    for (uint32_t rank = 0; rank < STATES; rank++)
+    {
+        if (GetCase(GetCube(rank)).value().first == rank)
+            ranks.push_back(rank);
+    }
+
+    // the search tables are built once, before the workers need them
+    TwoPhaseSolver::GetTables();
+
+    uint32_t count = ranks.size();
+    std::vector<std::vector<uint32_t>> solutions(count);
+    std::atomic<uint32_t> solved = 0;
+    std::atomic<bool> failed = false;
+    std::mutex progressMutex;
+    JobSystem::Get().ParallelFor(0, count, 16, [&](uint32_t first, uint32_t last) {
+        for (uint32_t i = first; i < last; i++)
+        {
+            auto solution = TwoPhaseSolver::Solve(GetCube(ranks[i]), SEARCH_LENGTH, std::chrono::milliseconds(SEARCH_MILLISECONDS));
+            if (!solution.has_value())
+            {
+                failed = true;
+                continue;
+            }
+
+            for (uint32_t move : solution.value())
+                CubieCube::AppendMove(solutions[i], move);
+
+            uint32_t done = ++solved;
+            if (progress && (done % 64 == 0 || done == count))
+            {
+                std::lock_guard lock(progressMutex);
+                progress((float)done / count);
+            }
+        }
+    });
+
+    if (failed)
+        return { };
+
+    std::vector<uint32_t> offsets = { 0 };
+    std::vector<uint8_t> nibbles;
+    uint32_t nibbleCount = 0;
+    for (const auto& solution : solutions)
+    {
+        for (uint32_t i = 0; i < solution.size(); i++)
+        {
+            uint32_t face = solution[i] / 3;
+            uint32_t power = solution[i] % 3;
+            if (i == 0)
+            {
+                PushNibble(nibbles, nibbleCount, face);
+                PushNibble(nibbles, nibbleCount, power);
+            }
+            else
+            {
+                // never the face of the previous move
+                PushNibble(nibbles, nibbleCount, (face + 5 - solution[i - 1] / 3) % 6 * 3 + power);
+            }
+        }
+        offsets.push_back(nibbleCount);
+    }
+
+    // the count, the ranks padded to 4 bytes, the offsets and the nibbles
+    size_t ranksSize = (count * sizeof(uint16_t) + 3) / 4 * 4;
+    std::vector<uint8_t> data(sizeof(uint32_t) + ranksSize + offsets.size() * sizeof(uint32_t) + nibbles.size(), 0);
+    uint8_t* cursor = data.data();
+    std::memcpy(cursor, &count, sizeof(uint32_t));
+    cursor += sizeof(uint32_t);
+    std::memcpy(cursor, ranks.data(), count * sizeof(uint16_t));
+    cursor += ranksSize;
+    std::memcpy(cursor, offsets.data(), offsets.size() * sizeof(uint32_t));
+    cursor += offsets.size() * sizeof(uint32_t);
+    std::memcpy(cursor, nibbles.data(), nibbles.size());
+
+    return data;
+}
+auto LastLayerSolver::_ReadTables(TableStore::Table table) -> std::optional<Tables>
+{
+    std::span<const uint8_t> bytes = table.GetBytes();
+    if (bytes.size() < sizeof(uint32_t))
+        return std::nullopt;
+
+    uint32_t count;
+    std::memcpy(&count, bytes.data(), sizeof(uint32_t));
+
+    size_t ranksSize = ((size_t)count * sizeof(uint16_t) + 3) / 4 * 4;
+    size_t offsetsSize = ((size_t)count + 1) * sizeof(uint32_t);
+    if (count > STATES || bytes.size() < sizeof(uint32_t) + ranksSize + offsetsSize)
+        return std::nullopt;
+
+    Tables tables;
+    const uint8_t* cursor = bytes.data() + sizeof(uint32_t);
+    tables.Ranks = { reinterpret_cast<const uint16_t*>(cursor), count };
+    cursor += ranksSize;
+    tables.Offsets = { reinterpret_cast<const uint32_t*>(cursor), count + 1 };
+    cursor += offsetsSize;
+    tables.Solutions = { cursor, bytes.data() + bytes.size() };
+
+    if (tables.Offsets.back() > tables.Solutions.size() * 2)
+        return std::nullopt;
+
+    // the spans stay valid, the mapping or the memory never moves
+    tables.Storage = std::move(table);
+    return tables;
+}
@@ -0,0 +1,70 @@
+#ifndef LASTLAYERSOLVER_H
+#define LASTLAYERSOLVER_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "TableStore/TableStore.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+// One-look last layer: a stored solution for every case of the 3x3 with only its U layer unsolved. A case is
+// the ranked state (see GetRank) with the smallest rank among its four pre-AUFs, so the table keeps a quarter
+// of the states. The solutions are searched offline (GenerateTables) and only looked up at runtime, a missing
+// table file leaves the last layer to OLL and PLL.
+//
+// The file holds the sorted case ranks as 16 bit integers, the offsets of their solutions and the solutions
+// packed in nibbles: the face and the power of the first move, then one nibble per move telling the face
+// relative to the previous one and the power.
+class LastLayerSolver
+{
+public:
+    static constexpr uint32_t CORNER_PERMUTATIONS = 24;
+    static constexpr uint32_t CORNER_TWISTS = 27;
+    // the edge permutations of the parity of the corner permutation
+    static constexpr uint32_t EDGE_PERMUTATIONS = 12;
+    static constexpr uint32_t EDGE_FLIPS = 8;
+    static constexpr uint32_t STATES = CORNER_PERMUTATIONS * CORNER_TWISTS * EDGE_PERMUTATIONS * EDGE_FLIPS;
+
+    static constexpr uint32_t TABLE_VERSION = 1;
+    // the length the search of a case stops at, and the time it gets to find a shorter one
+    static constexpr uint32_t SEARCH_LENGTH = 12;
+    static constexpr uint32_t SEARCH_MILLISECONDS = 100;
+
+    struct Tables
+    {
+        std::span<const uint16_t> Ranks;
+        // in nibbles, one more than the ranks
+        std::span<const uint32_t> Offsets;
+        std::span<const uint8_t> Solutions;
+
+        // the stored table the spans point into
+        TableStore::Table Storage;
+    };
+
+public:
+    // the moves solving a cube that only has its U layer unsolved, starting with the pre-AUF;
+    // nullopt for other cubes or when the table was not generated
+    static auto Solve(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>;
+
+    // the mapped table, nullptr when its file is missing
+    static auto GetTables() -> const Tables*;
+    // searches every case and writes the table file, which takes minutes, progress is called from the workers
+    static auto GenerateTables(const std::function<void(float)>& progress = { }) -> bool;
+
+    // nullopt unless only the U layer is unsolved
+    static auto GetRank(const CubieCube& cube) -> std::optional<uint32_t>;
+    static auto GetCube(uint32_t rank) -> CubieCube;
+    // the smallest rank among the pre-AUFs of the state, and the U turns reaching it
+    static auto GetCase(const CubieCube& cube) -> std::optional<std::pair<uint32_t, uint32_t>>;
+
+private:
+    static auto _BuildTables(const std::function<void(float)>& progress) -> std::vector<uint8_t>;
+    static auto _ReadTables(TableStore::Table table) -> std::optional<Tables>;
+};
+
+#endif
@@ -1,12 +1,18 @@
 #include "Cube/Cube.hpp"
 #include "CubeScrambler/CubeScrambler.hpp"
 #include "CubeSolver/CubeSolver.hpp"
+#include "CubieCube/CubieCube.hpp"
+#include "FaceletString/FaceletString.hpp"
 #include "GUI/GUI.hpp"
+#include "LastLayerSolver/LastLayerSolver.hpp"
+#include "OptimalSolver/OptimalSolver.hpp"
 
 #include <raylib.h>
 
 #include <array>
 #include <format>
+#include <iostream>
+#include <string_view>
 
 enum class GameState
 {
@@ -34,12 +40,28 @@ constexpr uint32_t WINDOW_HEIGHT = static_cast<uint32_t>(600 * WINDOW_SCALE);
 constexpr uint32_t WINDOW_PADDING = static_cast<uint32_t>(10 * WINDOW_SCALE);
 constexpr uint32_t TEXT_SIZE = static_cast<uint32_t>(14 * WINDOW_SCALE);
 
+constexpr uint32_t MIN_CUBE_SIZE = 2;
+constexpr uint32_t MAX_CUBE_SIZE = 69;
+// how long the title tells why a paste was rejected
+constexpr double PASTE_ERROR_SECONDS = 3.0;
+
+constexpr std::chrono::milliseconds DUEL_THINKING_TIME = std::chrono::milliseconds(500);
+
 auto Menu() -> GameState;
 auto Playground(const Camera& camera) -> GameState;
 auto Duel(const Camera& camera) -> GameState;
+auto SolveOptimally(std::string_view facelets) -> int;
+auto GenerateLastLayerTables() -> int;
 
-int main()
+int main(int argc, char** argv)
 {
+    // headless mode: rubix --optimal <facelets>
+    if (argc == 3 && std::string_view(argv[1]) == "--optimal")
+        return SolveOptimally(argv[2]);
+    // offline: rubix --generate-last-layer, writes the one-look last layer table
+    if (argc == 2 && std::string_view(argv[1]) == "--generate-last-layer")
+        return GenerateLastLayerTables();
+
     SetConfigFlags(FLAG_MSAA_4X_HINT);
     SetTargetFPS(120);
 
@@ -79,6 +101,53 @@ int main()
     return 0;
 }
 
+auto SolveOptimally(std::string_view facelets) -> int
+{
+    Cube cube { 3, { 0.0f, 0.0f, 0.0f }, 1.0f };
+    if (FaceletString::GetSize(facelets) != 3 || FaceletString::Import(cube, facelets) != FaceletString::Validity::VALID)
+    {
+        std::cerr << "invalid 3x3 facelet string\n";
+        return 1;
+    }
+
+    auto cubieCube = CubieCube::FromCube(cube);
+    if (!cubieCube.has_value())
+    {
+        std::cerr << "invalid 3x3 facelet string\n";
+        return 1;
+    }
+
+    OptimalSolver::Result result = OptimalSolver::Solve(cubieCube.value());
+    if (!result.Moves.has_value())
+    {
+        std::cerr << std::format("no solution found, the optimal length is at least {}\n", result.Length);
+        return 1;
+    }
+
+    std::cout << std::format("solution: {}\n", CubieCube::FormatMoves(result.Moves.value()));
+    std::cout << std::format("length: {}\n", result.Length);
+    std::cout << std::format("nodes expanded: {}\n", result.NodesExpanded);
+    std::cout << std::format("nodes/s: {:.0f}\n", result.GetNodesPerSecond());
+    return 0;
+}
+
+auto GenerateLastLayerTables() -> int
+{
+    bool generated = LastLayerSolver::GenerateTables([](float progress) {
+        std::cout << std::format("\rsearching the last layer cases: {:.0f}%", progress * 100.0f) << std::flush;
+    });
+    std::cout << '\n';
+
+    if (!generated)
+    {
+        std::cerr << std::format("could not write the table to {}\n", TableStore::GetDirectory().string());
+        return 1;
+    }
+
+    std::cout << std::format("table written to {}\n", TableStore::GetDirectory().string());
+    return 0;
+}
+
 auto Menu() -> GameState
 {
     GameState nextState = GameState::MENU;
@@ -123,7 +192,7 @@ auto Menu() -> GameState
 
 auto Playground(const Camera& camera) -> GameState
 {
-    static std::array<std::string, 9> texts = {
+    static std::array<std::string, 10> texts = {
         "U/F/R/B/L/D/M/E/S: CW turns",
         "SHIFT+U/F/R/B/L/D/M/E/S: CCW turns",
         "UP/DOWN: change animation speed",
@@ -132,12 +201,17 @@ auto Playground(const Camera& camera) -> GameState
         "SPACE: scramble cube",
         "ENTER: solve cube",
         "BACKSPACE: reset sube",
+        "CTRL+C/CTRL+V: copy/paste facelets",
         "ESCAPE: back to menu"
     };
 
     static Cube cube { 3, { 0, 0, 0 }, 2.0f };
     static CubeScrambler scrambler { cube };
-    static CubeSolver solver { cube };
+    static CubeSolver solver { cube, CubeSolver::Strategy::TWO_PHASE };
+
+    // why the last paste was rejected, and when
+    static std::string_view pasteError;
+    static double pasteErrorTime = 0.0;
 
     GameState nextState = GameState::PLAYGROUND;
 
@@ -145,10 +219,37 @@ auto Playground(const Camera& camera) -> GameState
     if (IsKeyPressed(KEY_ESCAPE))
     {
         SetWindowTitle("Rubix Cube");
+        solver.CancelSolve();
         cube.Reset();
         nextState = GameState::MENU;
     }
 
+    // facelets
+    if (IsKeyDown(KEY_LEFT_CONTROL))
+    {
+        if (IsKeyPressed(KEY_C))
+            SetClipboardText(FaceletString::Export(cube).c_str());
+        if (IsKeyPressed(KEY_V) && GetClipboardText() != nullptr)
+        {
+            std::string_view facelets = GetClipboardText();
+            uint32_t size = FaceletString::GetSize(facelets);
+            FaceletString::Validity validity = size >= MIN_CUBE_SIZE && size <= MAX_CUBE_SIZE ?
+                FaceletString::Validate(facelets) : FaceletString::Validity::INVALID_LENGTH;
+
+            if (validity == FaceletString::Validity::VALID)
+            {
+                solver.CancelSolve();
+                FaceletString::Import(cube, facelets);
+                pasteError = { };
+            }
+            else
+            {
+                pasteError = FaceletString::GetValidityName(validity);
+                pasteErrorTime = GetTime();
+            }
+        }
+    }
+
     // moves
     if (IsKeyDown(KEY_LEFT_SHIFT))
     {
@@ -195,11 +296,17 @@ auto Playground(const Camera& camera) -> GameState
 
     // algorithms
     if (IsKeyPressed(KEY_BACKSPACE))
+    {
+        solver.CancelSolve();
         cube.Reset();
+    }
     if (IsKeyPressed(KEY_SPACE))
+    {
+        solver.CancelSolve();
         scrambler.Scramble();
+    }
     if (IsKeyPressed(KEY_ENTER))
-        solver.Solve();
+        solver.SolveAsync();
     if (IsKeyPressed(KEY_TAB))
         cube.SetAnimationsEnabled(!cube.GetAnimationsEnabled());
     if (IsKeyPressed(KEY_UP))
@@ -209,13 +316,15 @@ auto Playground(const Camera& camera) -> GameState
     if (IsKeyPressed(KEY_LEFT))
     {
         uint32_t cubeSize = cube.GetSize();
-        cubeSize = cubeSize > 2 ? cubeSize - 1 : 2;
+        cubeSize = cubeSize > MIN_CUBE_SIZE ? cubeSize - 1 : MIN_CUBE_SIZE;
+        solver.CancelSolve();
         cube.SetSize(cubeSize);
     }
     if (IsKeyPressed(KEY_RIGHT))
     {
         uint32_t cubeSize = cube.GetSize();
-        cubeSize = cubeSize < 69 ? cubeSize + 1 : 69;
+        cubeSize = cubeSize < MAX_CUBE_SIZE ? cubeSize + 1 : MAX_CUBE_SIZE;
+        solver.CancelSolve();
         cube.SetSize(cubeSize);
     }
 
@@ -229,8 +338,15 @@ auto Playground(const Camera& camera) -> GameState
     if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
         EnableCursor();
 
+    // the plan is executed once the worker has it
+    solver.Update();
+
     // check if solved
-    if (cube.IsSolved())
+    if (solver.IsSolving())
+        SetWindowTitle(std::format("Rubix Cube [SOLVING {:.0f}%]", solver.GetProgress() * 100.0f).c_str());
+    else if (!pasteError.empty() && GetTime() - pasteErrorTime < PASTE_ERROR_SECONDS)
+        SetWindowTitle(std::format("Rubix Cube [PASTE REJECTED: {}]", pasteError).c_str());
+    else if (cube.IsSolved())
         SetWindowTitle("Rubix Cube [SOLVED]");
     else
         SetWindowTitle("Rubix Cube");   
@@ -273,7 +389,7 @@ auto Playground(const Camera& camera) -> GameState
 auto Duel(const Camera& camera) -> GameState
 {
     static std::array<std::string, 5> texts = {
-        "UP/DOWN: adjust difficulty (speed)",
+        "UP/DOWN: adjust difficulty (speed, thinking time)",
         "TAB: toggle scramble animation",
         "LEFT/RIGHT: change cube size",
         "SPACE: scramble, start/stop",
@@ -282,7 +398,7 @@ auto Duel(const Camera& camera) -> GameState
 
     static Cube cube { 3, { 0, 0, 0 }, 2.0f };
     static CubeScrambler scrambler { cube };
-    static CubeSolver solver { cube };
+    static CubeSolver solver { cube, CubeSolver::Strategy::TWO_PHASE };
 
     static std::string scramble = "";
     static DuelState state = DuelState::START;
@@ -292,6 +408,7 @@ auto Duel(const Camera& camera) -> GameState
     if (IsKeyPressed(KEY_ESCAPE))
     {
         SetWindowTitle("Rubix Cube");
+        solver.CancelSolve();
         cube.Reset();
         state = DuelState::START;
         nextState = GameState::MENU;
@@ -305,20 +422,32 @@ auto Duel(const Camera& camera) -> GameState
         if (state == DuelState::SCRAMBLING)
             cube.FinishAllQueuedMoves();
     }
+    // a harder computer turns faster and thinks longer for shorter solutions
+    static std::chrono::milliseconds thinkingTime = DUEL_THINKING_TIME;
     if (IsKeyPressed(KEY_UP))
+    {
         cube.SetAnimationSpeed(cube.GetAnimationSpeed() / 0.9f);
+        thinkingTime = thinkingTime * 10 / 9;
+    }
     if (IsKeyPressed(KEY_DOWN))
+    {
         cube.SetAnimationSpeed(cube.GetAnimationSpeed() * 0.9f);
+        thinkingTime = thinkingTime * 9 / 10;
+    }
 
     // algorithms
     if (IsKeyPressed(KEY_BACKSPACE))
+    {
+        solver.CancelSolve();
         cube.Reset();
+    }
     if (IsKeyPressed(KEY_LEFT))
     {
         uint32_t cubeSize = cube.GetSize();
-        uint32_t newCubeSize = cubeSize > 2 ? cubeSize - 1 : 2;
+        uint32_t newCubeSize = cubeSize > MIN_CUBE_SIZE ? cubeSize - 1 : MIN_CUBE_SIZE;
         if (newCubeSize != cubeSize)
         {
+            solver.CancelSolve();
             cube.SetSize(newCubeSize);
             state = DuelState::START;
         }
@@ -329,6 +458,7 @@ auto Duel(const Camera& camera) -> GameState
         uint32_t newCubeSize = cubeSize < 3 ? cubeSize + 1 : 3;
         if (newCubeSize != cubeSize)
         {
+            solver.CancelSolve();
             cube.SetSize(newCubeSize);
             state = DuelState::START;
         }
@@ -344,6 +474,9 @@ auto Duel(const Camera& camera) -> GameState
     if (IsMouseButtonReleased(MOUSE_LEFT_BUTTON))
         EnableCursor();
 
+    // the plan is executed once the worker has it
+    solver.Update();
+
     // check if solved
     bool solved = cube.IsSolved();
     if (solved)
@@ -370,7 +503,7 @@ auto Duel(const Camera& camera) -> GameState
         if (IsKeyPressed(KEY_SPACE))
         {
             startTime = GetTime();
-            solver.Solve();
+            solver.SolveAsync();
             state = DuelState::BOTH_SOLVING;
         }
         break;
@@ -412,6 +545,10 @@ auto Duel(const Camera& camera) -> GameState
             if (!animations)
                 cube.FinishAllQueuedMoves();
             state = DuelState::SCRAMBLING;
+
+            // the colors are scrambled already, the computer thinks while the scramble is animated
+            solver.SetThinkingTime(thinkingTime);
+            solver.PlanAsync();
         }
         break;
     }
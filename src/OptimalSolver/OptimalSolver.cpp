@@ -0,0 +1,460 @@
+#include "OptimalSolver.hpp"
+
+#include "StateRank/StateRank.hpp"
+#include "Symmetry/Symmetry.hpp"
+#include "TwoPhaseSolver/TwoPhaseSolver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <numeric>
+
+// the tracked edges at the positions of a partial permutation with the given flips
+static auto UnrankEdges(uint32_t permutation, uint32_t flips) -> OptimalSolver::EdgePieces
+{
+    OptimalSolver::EdgePieces pieces;
+    uint32_t unused = 0xFFF;
+    for (uint32_t k = 0; k < 6; k++)
+    {
+        uint32_t digit = permutation / OptimalSolver::s_EdgeWeights[k];
+        permutation %= OptimalSolver::s_EdgeWeights[k];
+
+        uint32_t remaining = unused;
+        for (uint32_t j = 0; j < digit; j++)
+            remaining &= remaining - 1;
+
+        uint32_t position = std::countr_zero(remaining);
+        unused &= ~(1u << position);
+        pieces[k] = position << 1 | ((flips >> k) & 1);
+    }
+
+    return pieces;
+}
+
+static auto GetEdgePermutation(const OptimalSolver::EdgePieces& pieces) -> uint32_t
+{
+    uint32_t permutation = 0, used = 0;
+    for (uint32_t k = 0; k < 6; k++)
+    {
+        uint32_t position = pieces[k] >> 1;
+        permutation += (position - std::popcount(used & ((1u << position) - 1))) * OptimalSolver::s_EdgeWeights[k];
+        used |= 1u << position;
+    }
+
+    return permutation;
+}
+
+static auto SetEdges(const OptimalSolver::EdgePieces& pieces) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+
+    std::array<bool, 12> tracked { };
+    for (uint32_t k = 0; k < 6; k++)
+    {
+        cube.EdgePermutation[pieces[k] >> 1] = OptimalSolver::s_TrackedEdges[k];
+        cube.EdgeOrientation[pieces[k] >> 1] = pieces[k] & 1;
+        tracked[pieces[k] >> 1] = true;
+    }
+
+    // the other edges fill the remaining positions in order
+    uint8_t other = 0;
+    for (uint32_t position = 0; position < 12; position++)
+    {
+        if (tracked[position])
+            continue;
+
+        while (std::ranges::find(OptimalSolver::s_TrackedEdges, other) != OptimalSolver::s_TrackedEdges.end())
+            other++;
+        cube.EdgePermutation[position] = other++;
+        cube.EdgeOrientation[position] = 0;
+    }
+
+    return cube;
+}
+
+// numbers the classes of the permutations under the symmetries in the order of their smallest members, the
+// representatives; by permutation, its class shifted past the index of the symmetry taking it to the representative
+template<typename T>
+static auto BuildClasses(uint32_t permutations, uint32_t symmetries, const auto& conjugatePermutation) -> std::vector<T>
+{
+    uint32_t symmetryBits = std::countr_zero(symmetries);
+
+    std::vector<T> classes(permutations);
+    uint32_t count = 0;
+    for (uint32_t permutation = 0; permutation < permutations; permutation++)
+    {
+        uint32_t representative = permutation, representativeSymmetry = 0;
+        for (uint32_t i = 1; i < symmetries; i++)
+        {
+            uint32_t conjugate = conjugatePermutation(permutation, i);
+            if (conjugate < representative)
+            {
+                representative = conjugate;
+                representativeSymmetry = i;
+            }
+        }
+
+        uint32_t permutationClass = representative == permutation ? count++ : classes[representative] >> symmetryBits;
+        classes[permutation] = permutationClass << symmetryBits | representativeSymmetry;
+    }
+
+    return classes;
+}
+
+// the distances mod 3 of a database indexed by class times orientations plus the orientation conjugated by the
+// symmetry taking the permutation to its representative; getNeighbor gives the index after a move from the
+// permutation and orientation of an entry. A representative kept by other symmetries than the identity has
+// several entries for one state: the search runs over the smallest of their orientations and copies the
+// distances to the others.
+template<typename T>
+static auto BuildClassDistances(std::span<const T> classes, uint32_t classCount, uint32_t orientations, uint32_t symmetries,
+    const auto& orientationConjugates, uint32_t solved, const auto& conjugatePermutation, const auto& getNeighbor) -> std::vector<uint8_t>
+{
+    uint32_t symmetryBits = std::countr_zero(symmetries);
+    uint32_t size = classCount * orientations;
+
+    std::vector<uint32_t> representatives(classCount);
+    for (uint32_t permutation = classes.size(); permutation-- > 0;)
+        representatives[classes[permutation] >> symmetryBits] = permutation;
+
+    std::vector<std::vector<uint32_t>> stabilizers(classCount);
+    for (uint32_t permutationClass = 0; permutationClass < classCount; permutationClass++)
+    {
+        for (uint32_t i = 1; i < symmetries; i++)
+        {
+            if (conjugatePermutation(representatives[permutationClass], i) == representatives[permutationClass])
+                stabilizers[permutationClass].push_back(i);
+        }
+    }
+    auto getSmallestIndex = [&](uint32_t index) {
+        uint32_t permutationClass = index / orientations;
+        uint32_t orientation = index % orientations;
+        uint32_t smallest = orientation;
+        for (uint32_t i : stabilizers[permutationClass])
+            smallest = std::min<uint32_t>(smallest, orientationConjugates[orientation * symmetries + i]);
+
+        return permutationClass * orientations + smallest;
+    };
+
+    std::array<uint32_t, CubieCube::MOVE_COUNT> allMoves;
+    std::iota(allMoves.begin(), allMoves.end(), 0);
+    std::vector<uint8_t> distances = TableStore::BuildDistances(size, 4, getSmallestIndex(solved), allMoves, [&](uint32_t index, uint32_t move) {
+        return getSmallestIndex(getNeighbor(representatives[index / orientations], index % orientations, move));
+    });
+    for (uint32_t index = 0; index < size; index++)
+    {
+        uint32_t smallest = getSmallestIndex(index);
+        uint8_t distance = (distances[smallest >> 1] >> ((smallest & 1) * 4)) & 0xF;
+        distances[index >> 1] = (distances[index >> 1] & ~(0xF << ((index & 1) * 4))) | distance << ((index & 1) * 4);
+    }
+
+    return TableStore::PackDistancesMod3(distances, size);
+}
+
+// the state of one solve: the corner coordinates and the pieces of both edge groups per node, the second
+// belonging to the conjugated cube that the other six edges are looked up in, and their exact distances
+struct OptimalSearch
+{
+    const OptimalSolver::Tables& Tables;
+    const TwoPhaseSolver::Tables& CoordinateTables;
+    uint32_t SolvedEdgeIndex;
+    std::chrono::steady_clock::time_point Deadline;
+
+    std::array<uint32_t, OptimalSolver::MAX_LENGTH> Moves;
+    uint64_t Nodes = 0;
+    bool TimedOut = false;
+
+    inline auto GetCornerDistanceMod3(uint32_t cornerPermutation, uint32_t twist) const -> uint32_t
+    {
+        return OptimalSolver::GetDistanceMod3(Tables.CornerDistances, OptimalSolver::GetCornerIndex(Tables, cornerPermutation, twist));
+    }
+    inline auto GetEdgeDistanceMod3(const OptimalSolver::EdgePieces& pieces) const -> uint32_t
+    {
+        return OptimalSolver::GetDistanceMod3(Tables.EdgeDistances, OptimalSolver::GetEdgeIndex(Tables, pieces));
+    }
+    inline auto GetEdgesAfter(const OptimalSolver::EdgePieces& pieces, uint32_t move) const -> OptimalSolver::EdgePieces
+    {
+        OptimalSolver::EdgePieces next;
+        for (uint32_t k = 0; k < 6; k++)
+            next[k] = Tables.EdgeMoves[pieces[k] * CubieCube::MOVE_COUNT + move];
+
+        return next;
+    }
+
+    // the exact distances at the start, stepping to a neighbor one closer until the pieces are solved
+    auto GetCornerDistance(uint32_t cornerPermutation, uint32_t twist) const -> uint32_t
+    {
+        uint32_t distance = 0;
+        for (; (cornerPermutation != 0 || twist != 0) && distance < OptimalSolver::MAX_LENGTH; distance++)
+        {
+            uint32_t closer = (GetCornerDistanceMod3(cornerPermutation, twist) + 2) % 3;
+            for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+            {
+                uint32_t nextCornerPermutation = CoordinateTables.CornerPermutationMoves[cornerPermutation * CubieCube::MOVE_COUNT + move];
+                uint32_t nextTwist = CoordinateTables.TwistMoves[twist * CubieCube::MOVE_COUNT + move];
+                if (GetCornerDistanceMod3(nextCornerPermutation, nextTwist) == closer)
+                {
+                    cornerPermutation = nextCornerPermutation;
+                    twist = nextTwist;
+                    break;
+                }
+            }
+        }
+
+        return distance;
+    }
+    auto GetEdgeDistance(OptimalSolver::EdgePieces edges) const -> uint32_t
+    {
+        uint32_t distance = 0;
+        for (; OptimalSolver::GetEdgeIndex(Tables, edges) != SolvedEdgeIndex && distance < OptimalSolver::MAX_LENGTH; distance++)
+        {
+            uint32_t closer = (GetEdgeDistanceMod3(edges) + 2) % 3;
+            for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+            {
+                OptimalSolver::EdgePieces nextEdges = GetEdgesAfter(edges, move);
+                if (GetEdgeDistanceMod3(nextEdges) == closer)
+                {
+                    edges = nextEdges;
+                    break;
+                }
+            }
+        }
+
+        return distance;
+    }
+
+    auto Search(uint32_t cornerPermutation, uint32_t twist, uint32_t cornerDistance, const OptimalSolver::EdgePieces& edges, uint32_t edgeDistance,
+        const OptimalSolver::EdgePieces& otherEdges, uint32_t otherDistance, uint32_t depth, uint32_t togo) -> bool
+    {
+        if (togo == 0)
+            return cornerDistance == 0 && edgeDistance == 0 && otherDistance == 0;
+
+        if (++Nodes % 65536 == 0 && std::chrono::steady_clock::now() >= Deadline)
+            TimedOut = true;
+        if (TimedOut)
+            return false;
+
+        for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+        {
+            // no two moves on one face, and opposite faces only in one order
+            if (depth > 0 && (move / 3 == Moves[depth - 1] / 3 || move / 3 + 3 == Moves[depth - 1] / 3))
+                continue;
+
+            uint32_t nextCornerPermutation = CoordinateTables.CornerPermutationMoves[cornerPermutation * CubieCube::MOVE_COUNT + move];
+            uint32_t nextTwist = CoordinateTables.TwistMoves[twist * CubieCube::MOVE_COUNT + move];
+            uint32_t nextCornerDistance = OptimalSolver::GetNeighborDistance(cornerDistance, GetCornerDistanceMod3(nextCornerPermutation, nextTwist));
+            if (nextCornerDistance >= togo)
+                continue;
+
+            OptimalSolver::EdgePieces nextEdges = GetEdgesAfter(edges, move);
+            uint32_t nextEdgeDistance = OptimalSolver::GetNeighborDistance(edgeDistance, GetEdgeDistanceMod3(nextEdges));
+            if (nextEdgeDistance >= togo)
+                continue;
+
+            OptimalSolver::EdgePieces nextOtherEdges = GetEdgesAfter(otherEdges, Symmetry::ConjugateMove(Tables.EdgeSymmetry, move));
+            uint32_t nextOtherDistance = OptimalSolver::GetNeighborDistance(otherDistance, GetEdgeDistanceMod3(nextOtherEdges));
+            if (nextOtherDistance >= togo)
+                continue;
+
+            Moves[depth] = move;
+            if (Search(nextCornerPermutation, nextTwist, nextCornerDistance, nextEdges, nextEdgeDistance, nextOtherEdges, nextOtherDistance, depth + 1, togo - 1))
+                return true;
+        }
+
+        return false;
+    }
+};
+
+auto OptimalSolver::Solve(const CubieCube& cube, std::chrono::milliseconds timeout) -> Result
+{
+    auto start = std::chrono::steady_clock::now();
+
+    OptimalSearch search {
+        .Tables = GetTables(),
+        .CoordinateTables = TwoPhaseSolver::GetTables(),
+        .SolvedEdgeIndex = GetEdgeIndex(CubieCube::Solved()),
+        .Deadline = timeout == std::chrono::milliseconds::max() ? std::chrono::steady_clock::time_point::max() : start + timeout,
+        .Moves = { }
+    };
+
+    uint32_t cornerPermutation = TwoPhaseSolver::GetCornerPermutation(cube);
+    uint32_t twist = TwoPhaseSolver::GetTwist(cube);
+    EdgePieces edges = GetEdgePieces(cube);
+    EdgePieces otherEdges = GetEdgePieces(Symmetry::Conjugate(cube, search.Tables.EdgeSymmetry));
+
+    uint32_t cornerDistance = search.GetCornerDistance(cornerPermutation, twist);
+    uint32_t edgeDistance = search.GetEdgeDistance(edges);
+    uint32_t otherDistance = search.GetEdgeDistance(otherEdges);
+    uint32_t length = std::max({ cornerDistance, edgeDistance, otherDistance });
+
+    Result result { std::nullopt, length, 0, 0.0 };
+    for (; length <= MAX_LENGTH && !search.TimedOut; length++)
+    {
+        result.Length = length;
+        if (search.Search(cornerPermutation, twist, cornerDistance, edges, edgeDistance, otherEdges, otherDistance, 0, length))
+        {
+            result.Moves = std::vector<uint32_t>(search.Moves.begin(), search.Moves.begin() + length);
+            break;
+        }
+    }
+
+    result.NodesExpanded = search.Nodes;
+    result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+auto OptimalSolver::GetTables() -> const Tables&
+{
+    static const Tables tables = _BuildTables();
+    return tables;
+}
+
+auto OptimalSolver::GetCornerIndex(const CubieCube& cube) -> uint32_t
+{
+    return GetCornerIndex(GetTables(), TwoPhaseSolver::GetCornerPermutation(cube), TwoPhaseSolver::GetTwist(cube));
+}
+auto OptimalSolver::GetEdgeIndex(const CubieCube& cube) -> uint32_t
+{
+    return GetEdgeIndex(GetTables(), GetEdgePieces(cube));
+}
+auto OptimalSolver::GetEdgePieces(const CubieCube& cube) -> EdgePieces
+{
+    EdgePieces pieces;
+    for (uint32_t position = 0; position < 12; position++)
+    {
+        auto tracked = std::ranges::find(s_TrackedEdges, cube.EdgePermutation[position]);
+        if (tracked != s_TrackedEdges.end())
+            pieces[tracked - s_TrackedEdges.begin()] = position << 1 | cube.EdgeOrientation[position];
+    }
+
+    return pieces;
+}
+
+auto OptimalSolver::_BuildTables() -> Tables
+{
+    const TwoPhaseSolver::Tables& coordinateTables = TwoPhaseSolver::GetTables();
+
+    Tables tables;
+    auto load = [&tables](std::string_view name, const auto& build) -> const TableStore::Table& {
+        return tables.Storage.emplace_back(TableStore::Load(name, TABLE_VERSION, build));
+    };
+
+    // an edge moves alone: the flip of one edge does not change where it goes
+    for (uint32_t position = 0; position < 12; position++)
+    {
+        for (uint32_t flip = 0; flip < 2; flip++)
+        {
+            CubieCube cube = CubieCube::Solved();
+            cube.EdgeOrientation[position] = flip;
+            for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+            {
+                CubieCube turned = cube;
+                turned.Multiply(CubieCube::GetMove(move));
+
+                uint32_t next = std::ranges::find(turned.EdgePermutation, position) - turned.EdgePermutation.begin();
+                tables.EdgeMoves[(position << 1 | flip) * CubieCube::MOVE_COUNT + move] = next << 1 | turned.EdgeOrientation[next];
+            }
+        }
+    }
+
+    // a rotation whose conjugation moves the other six edges to the tracked ones
+    for (uint32_t symmetry = 0; symmetry < Symmetry::COUNT; symmetry += 2)
+    {
+        const CubieCube& inverse = Symmetry::GetSymmetry(Symmetry::GetInverse(symmetry));
+        bool disjoint = std::ranges::none_of(s_TrackedEdges, [&inverse](uint8_t edge) {
+            return std::ranges::find(s_TrackedEdges, inverse.EdgePermutation[edge]) != s_TrackedEdges.end();
+        });
+        if (disjoint)
+        {
+            tables.EdgeSymmetry = symmetry;
+            break;
+        }
+    }
+
+    // the symmetries keeping the UD axis turn U into U or D
+    uint32_t cornerSymmetries = 0;
+    for (uint32_t symmetry = 0; symmetry < Symmetry::COUNT && cornerSymmetries < CORNER_SYMMETRIES; symmetry++)
+    {
+        if (Symmetry::ConjugateMove(symmetry, 0) / 3 % 3 == 0)
+            tables.CornerSymmetries[cornerSymmetries++] = symmetry;
+    }
+
+    auto conjugateCorners = [&tables](uint32_t cornerPermutation, uint32_t i) {
+        CubieCube cube = CubieCube::Solved();
+        StateRank::UnrankPermutation(cornerPermutation, cube.CornerPermutation);
+        return TwoPhaseSolver::GetCornerPermutation(Symmetry::Conjugate(cube, tables.CornerSymmetries[i]));
+    };
+    tables.CornerClasses = load("optimal_corner_classes", [&conjugateCorners] {
+        return BuildClasses<uint16_t>(CORNER_PERMUTATIONS, CORNER_SYMMETRIES, conjugateCorners);
+    }).As<uint16_t>();
+    // the symmetries keeping the UD axis keep the twist a function of the twist alone
+    tables.TwistConjugates = load("optimal_twist_conjugates", [&tables] {
+        std::vector<uint16_t> conjugates(TwoPhaseSolver::TWISTS * CORNER_SYMMETRIES);
+        for (uint32_t twist = 0; twist < TwoPhaseSolver::TWISTS; twist++)
+        {
+            CubieCube cube = CubieCube::Solved();
+            StateRank::UnrankTwist(twist, cube.CornerOrientation);
+            for (uint32_t i = 0; i < CORNER_SYMMETRIES; i++)
+                conjugates[twist * CORNER_SYMMETRIES + i] = TwoPhaseSolver::GetTwist(Symmetry::Conjugate(cube, tables.CornerSymmetries[i]));
+        }
+
+        return conjugates;
+    }).As<uint16_t>();
+
+    tables.CornerDistances = load("optimal_corner_distances", [&] {
+        return BuildClassDistances(tables.CornerClasses, CORNER_CLASSES, TwoPhaseSolver::TWISTS, CORNER_SYMMETRIES, tables.TwistConjugates, 0,
+            conjugateCorners, [&](uint32_t cornerPermutation, uint32_t twist, uint32_t move) {
+                return GetCornerIndex(tables, coordinateTables.CornerPermutationMoves[cornerPermutation * CubieCube::MOVE_COUNT + move],
+                    coordinateTables.TwistMoves[twist * CubieCube::MOVE_COUNT + move]);
+            });
+    }).GetBytes();
+
+    // the symmetries keeping the tracked edges and flipping no edge only relabel the flips of the tracked edges
+    uint32_t edgeSymmetries = 0;
+    for (uint32_t symmetry = 0; symmetry < Symmetry::COUNT && edgeSymmetries < EDGE_SYMMETRIES; symmetry++)
+    {
+        const CubieCube& cube = Symmetry::GetSymmetry(symmetry);
+        bool keepsTracked = std::ranges::all_of(s_TrackedEdges, [&cube](uint8_t edge) {
+            return std::ranges::find(s_TrackedEdges, cube.EdgePermutation[edge]) != s_TrackedEdges.end();
+        });
+        if (keepsTracked && std::ranges::none_of(cube.EdgeOrientation, std::identity { }))
+            tables.EdgeSymmetries[edgeSymmetries++] = symmetry;
+    }
+    auto conjugateEdges = [&tables](const EdgePieces& pieces, uint32_t i) {
+        return GetEdgePieces(Symmetry::Conjugate(SetEdges(pieces), tables.EdgeSymmetries[i]));
+    };
+    auto conjugateEdgePermutation = [&conjugateEdges](uint32_t permutation, uint32_t i) {
+        return GetEdgePermutation(conjugateEdges(UnrankEdges(permutation, 0), i));
+    };
+
+    for (uint32_t flips = 0; flips < 64; flips++)
+    {
+        for (uint32_t i = 0; i < EDGE_SYMMETRIES; i++)
+        {
+            EdgePieces conjugate = conjugateEdges(UnrankEdges(0, flips), i);
+            uint8_t conjugateFlips = 0;
+            for (uint32_t k = 0; k < 6; k++)
+                conjugateFlips |= (conjugate[k] & 1) << k;
+
+            tables.FlipConjugates[flips * EDGE_SYMMETRIES + i] = conjugateFlips;
+        }
+    }
+
+    tables.EdgeClasses = load("optimal_edge_classes", [&conjugateEdgePermutation] {
+        return BuildClasses<uint32_t>(EDGE_PERMUTATIONS, EDGE_SYMMETRIES, conjugateEdgePermutation);
+    }).As<uint32_t>();
+
+    tables.EdgeDistances = load("optimal_edge_distances", [&] {
+        uint32_t solved = GetEdgeIndex(tables, GetEdgePieces(CubieCube::Solved()));
+        return BuildClassDistances(tables.EdgeClasses, EDGE_CLASSES, 64, EDGE_SYMMETRIES, tables.FlipConjugates, solved,
+            conjugateEdgePermutation, [&tables](uint32_t permutation, uint32_t flips, uint32_t move) {
+                EdgePieces pieces = UnrankEdges(permutation, flips);
+                for (uint8_t& piece : pieces)
+                    piece = tables.EdgeMoves[piece * CubieCube::MOVE_COUNT + move];
+
+                return GetEdgeIndex(tables, pieces);
+            });
+    }).GetBytes();
+
+    return tables;
+}
@@ -0,0 +1,135 @@
+#ifndef OPTIMALSOLVER_H
+#define OPTIMALSOLVER_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "TableStore/TableStore.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Optimal 3x3 solutions by IDA* (Korf): the heuristic is the largest of the distances of the corners and of
+// two groups of six edges, read from pattern databases. The second edge group is the image of the first
+// under a whole cube rotation, so both are looked up in the same table.
+//
+// The databases hold 2 bits per entry, the distance mod 3: the search starts from the exact distances of the
+// scramble and tracks them move by move. Both databases are indexed by symmetry classes, the orientations
+// conjugated by the symmetry taking the permutation to its class representative: the corners by the 2768
+// classes of their permutation under the 16 symmetries keeping the UD axis, the edges by the 166944 classes
+// of their permutation under the 4 symmetries keeping the tracked edges and their flips. The edges are moved
+// piece by piece, so no move table of the edge permutations is needed; all tables take 7 MB.
+class OptimalSolver
+{
+public:
+    static constexpr uint32_t CORNER_PERMUTATIONS = 40320;
+    static constexpr uint32_t CORNER_SYMMETRIES = 16;
+    static constexpr uint32_t CORNER_CLASSES = 2768;
+    static constexpr uint32_t CORNER_STATES = CORNER_CLASSES * 2187;
+    static constexpr uint32_t EDGE_PERMUTATIONS = 12 * 11 * 10 * 9 * 8 * 7;
+    static constexpr uint32_t EDGE_SYMMETRIES = 4;
+    static constexpr uint32_t EDGE_CLASSES = 166944;
+    static constexpr uint32_t EDGE_STATES = EDGE_CLASSES * 64;
+    static constexpr uint32_t MAX_LENGTH = 20;
+    static constexpr uint32_t TABLE_VERSION = 3;
+
+    // the tracked edges UR, UL, DR, DL, FR, BL
+    static constexpr std::array<uint8_t, 6> s_TrackedEdges = { 0, 2, 4, 6, 8, 10 };
+    // the weights of the digits of a partial permutation of 6 out of 12
+    static constexpr std::array<uint32_t, 6> s_EdgeWeights = { 11 * 10 * 9 * 8 * 7, 10 * 9 * 8 * 7, 9 * 8 * 7, 8 * 7, 7, 1 };
+
+    // the position times 2 plus the flip of each tracked edge
+    using EdgePieces = std::array<uint8_t, 6>;
+
+    struct Result
+    {
+        // empty if the search ran out of time, the length is then a lower bound
+        std::optional<std::vector<uint32_t>> Moves;
+        uint32_t Length;
+        uint64_t NodesExpanded;
+        double Seconds;
+
+        inline auto GetNodesPerSecond() const -> double { return Seconds > 0.0 ? NodesExpanded / Seconds : 0.0; }
+    };
+
+    struct Tables
+    {
+        // by position times 2 plus flip of an edge and move, the position and flip after the move
+        std::array<uint8_t, 24 * CubieCube::MOVE_COUNT> EdgeMoves;
+
+        // by corner permutation, its class times 16 plus the symmetry taking it to the class representative
+        std::span<const uint16_t> CornerClasses;
+        // by twist times 16 plus symmetry, the twist of the conjugated state
+        std::span<const uint16_t> TwistConjugates;
+        // the symmetries keeping the UD axis
+        std::array<uint32_t, CORNER_SYMMETRIES> CornerSymmetries;
+
+        // by edge permutation, its class times 4 plus the symmetry taking it to the class representative
+        std::span<const uint32_t> EdgeClasses;
+        // by flips times 4 plus symmetry, the flips of the conjugated state
+        std::array<uint8_t, 64 * EDGE_SYMMETRIES> FlipConjugates;
+        // the symmetries keeping the tracked edges and their flips
+        std::array<uint32_t, EDGE_SYMMETRIES> EdgeSymmetries;
+
+        // the distances mod 3 packed into 2 bits
+        std::span<const uint8_t> CornerDistances;
+        std::span<const uint8_t> EdgeDistances;
+
+        // the rotation taking the other six edges onto the tracked ones
+        uint32_t EdgeSymmetry;
+
+        // the stored tables the spans point into
+        std::vector<TableStore::Table> Storage;
+    };
+
+public:
+    static auto Solve(const CubieCube& cube, std::chrono::milliseconds timeout = std::chrono::milliseconds::max()) -> Result;
+
+    static auto GetTables() -> const Tables&;
+
+    static auto GetCornerIndex(const CubieCube& cube) -> uint32_t;
+    static auto GetEdgeIndex(const CubieCube& cube) -> uint32_t;
+    static auto GetEdgePieces(const CubieCube& cube) -> EdgePieces;
+
+    static inline auto GetCornerIndex(const Tables& tables, uint32_t cornerPermutation, uint32_t twist) -> uint32_t
+    {
+        uint32_t cornerClass = tables.CornerClasses[cornerPermutation];
+        return (cornerClass >> 4) * 2187 + tables.TwistConjugates[twist * CORNER_SYMMETRIES + (cornerClass & 15)];
+    }
+
+    static inline auto GetEdgeIndex(const Tables& tables, const EdgePieces& pieces) -> uint32_t
+    {
+        // a digit counts the free positions below an edge, the positions are distinct so the flips do not
+        // change the comparisons
+        uint32_t permutation = 0, flips = 0;
+        for (uint32_t k = 0; k < 6; k++)
+        {
+            uint32_t digit = pieces[k] >> 1;
+            for (uint32_t j = 0; j < k; j++)
+                digit -= pieces[j] < pieces[k];
+
+            permutation += digit * s_EdgeWeights[k];
+            flips |= (pieces[k] & 1u) << k;
+        }
+
+        uint32_t edgeClass = tables.EdgeClasses[permutation];
+        return (edgeClass >> 2) * 64 + tables.FlipConjugates[flips * EDGE_SYMMETRIES + (edgeClass & 3)];
+    }
+
+    static inline auto GetDistanceMod3(std::span<const uint8_t> distances, uint32_t index) -> uint32_t
+    {
+        return (distances[index >> 2] >> ((index & 3) * 2)) & 3;
+    }
+    // the distance of a neighbor of a state at the given distance
+    static inline auto GetNeighborDistance(uint32_t distance, uint32_t distanceMod3) -> uint32_t
+    {
+        return distance + (distanceMod3 + 4 - distance % 3) % 3 - 1;
+    }
+
+private:
+    static auto _BuildTables() -> Tables;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "PairTable.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+PairTable::PairTable(std::span<const std::string_view> algorithms)
+{
+    for (std::string_view algorithm : algorithms)
+    {
+        CubieCube moves = CubieCube::Solved();
+        if (!moves.ApplyMoves(algorithm))
+            continue;
+
+        // the case the algorithm solves, the first algorithm listed for it wins
+        std::vector<uint32_t>& solution = m_Cases[GetKey(moves.GetInverse())];
+        if (!solution.empty())
+            continue;
+
+        for (auto token : algorithm | std::views::split(' '))
+        {
+            std::string_view move(token.begin(), token.end());
+            if (!move.empty())
+                solution.push_back(CubieCube::GetMoveIndex(move).value());
+        }
+    }
+}
+
+auto PairTable::Find(const CubieCube& cube) const -> const std::vector<uint32_t>*
+{
+    const std::vector<uint32_t>& solution = m_Cases[GetKey(cube)];
+    return solution.empty() ? nullptr : &solution;
+}
+
+auto PairTable::GetKey(const CubieCube& cube) -> uint32_t
+{
+    uint32_t corner = std::find(cube.CornerPermutation.begin(), cube.CornerPermutation.end(), CORNER) - cube.CornerPermutation.begin();
+    uint32_t edge = std::find(cube.EdgePermutation.begin(), cube.EdgePermutation.end(), EDGE) - cube.EdgePermutation.begin();
+
+    return ((corner * 3 + cube.CornerOrientation[corner]) * 12 + edge) * 2 + cube.EdgeOrientation[edge];
+}
+auto PairTable::IsSolved(const CubieCube& cube) -> bool
+{
+    return cube.CornerPermutation[CORNER] == CORNER && cube.CornerOrientation[CORNER] == 0 &&
+        cube.EdgePermutation[EDGE] == EDGE && cube.EdgeOrientation[EDGE] == 0;
+}
@@ -0,0 +1,38 @@
+#ifndef PAIRTABLE_H
+#define PAIRTABLE_H
+
+#include "CubieCube/CubieCube.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// The F2L cases of the front right pair (the DFR corner and the FR edge), keyed by the positions and the
+// orientations of its two pieces. Each algorithm inserts the pair without touching the cross or the other
+// slots, and its key is read from the solved cube it is undone on, so the table only lists the moves.
+// The other pairs are looked up from a whole cube rotation bringing them to the front right.
+class PairTable
+{
+public:
+    static constexpr uint32_t KEYS = 8 * 3 * 12 * 2;
+
+    static constexpr uint8_t CORNER = CubieCube::DFR;
+    static constexpr uint8_t EDGE = CubieCube::FR;
+
+public:
+    explicit PairTable(std::span<const std::string_view> algorithms);
+
+    // the moves inserting the front right pair, nullptr when its case is not listed
+    auto Find(const CubieCube& cube) const -> const std::vector<uint32_t>*;
+
+    static auto GetKey(const CubieCube& cube) -> uint32_t;
+    // both pieces in their slot and oriented
+    static auto IsSolved(const CubieCube& cube) -> bool;
+
+private:
+    std::array<std::vector<uint32_t>, KEYS> m_Cases;
+};
+
+#endif
@@ -41,4 +41,21 @@ auto PieceColors::HandleRotation(Direction direction, bool clockwise) -> void
         newColors[std::to_underlying(face)] = m_Colors[i];
     }
     m_Colors = newColors;
+}
+auto PieceColors::HandleTransition(const std::array<Face, 6>& transition) -> void
+{
+    std::array<FaceColor, 6> newColors;
+    for (int i = 0; i < 6; i++)
+        newColors[std::to_underlying(transition[i])] = m_Colors[i];
+    m_Colors = newColors;
+}
+
+auto PieceColors::GetFaceTransition(Direction direction, uint32_t quarterTurns) -> std::array<Face, 6>
+{
+    std::array<Face, 6> transition = { Face::Top, Face::Front, Face::Right, Face::Back, Face::Left, Face::Bottom };
+    for (uint32_t turn = 0; turn < quarterTurns % 4; turn++)
+        for (auto& face : transition)
+            face = s_FaceTransitionTensor[std::to_underlying(face)][std::to_underlying(direction)][0];
+
+    return transition;
 }
\ No newline at end of file
@@ -30,6 +30,10 @@ public:
     }
 
     auto HandleRotation(Direction direction, bool clockwise) -> void;
+    auto HandleTransition(const std::array<Face, 6>& transition) -> void;
+
+    // the face every face ends up on after the given number of clockwise quarter turns
+    static auto GetFaceTransition(Direction direction, uint32_t quarterTurns) -> std::array<Face, 6>;
 
 private:
     static std::array<std::array<std::array<Face, 2>, 3>, 6> s_FaceTransitionTensor;
@@ -0,0 +1,131 @@
+#include "PocketSolver.hpp"
+
+#include "StateRank/StateRank.hpp"
+
+#include <algorithm>
+
+static inline auto GetNeighbor(const PocketSolver::Tables& tables, uint32_t rank, uint32_t move) -> uint32_t
+{
+    return tables.PermutationMoves[rank / PocketSolver::TWISTS * CubieCube::MOVE_COUNT + move] * PocketSolver::TWISTS +
+        tables.TwistMoves[rank % PocketSolver::TWISTS * CubieCube::MOVE_COUNT + move];
+}
+
+// the rank expects the DBL corner in place and a permutation, and leaves out the twist of the last corner,
+// so a broken cube would pass for another state
+static auto IsValid(const CubieCube& cube) -> bool
+{
+    if (cube.CornerPermutation[CubieCube::DBL] != CubieCube::DBL || cube.CornerOrientation[CubieCube::DBL] != 0)
+        return false;
+
+    uint32_t seen = 0;
+    uint32_t twist = 0;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        if (cube.CornerPermutation[i] >= 8 || cube.CornerOrientation[i] >= 3)
+            return false;
+
+        seen |= 1u << cube.CornerPermutation[i];
+        twist += cube.CornerOrientation[i];
+    }
+
+    return seen == 0xFF && twist % 3 == 0;
+}
+
+auto PocketSolver::Solve(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>
+{
+    if (!IsValid(cube))
+        return std::nullopt;
+
+    const Tables& tables = GetTables();
+
+    std::vector<uint32_t> moves;
+    uint32_t rank = StateRank::Rank2x2(cube);
+    while (rank != 0)
+    {
+        if (moves.size() == MAX_LENGTH)
+            return std::nullopt;
+
+        uint8_t closer = (GetDistanceModulo3(tables, rank) + 2) % 3;
+        auto move = std::ranges::find_if(s_Moves, [&](uint32_t move) { return GetDistanceModulo3(tables, GetNeighbor(tables, rank, move)) == closer; });
+        if (move == s_Moves.end())
+            return std::nullopt;
+
+        moves.push_back(*move);
+        rank = GetNeighbor(tables, rank, *move);
+    }
+
+    return moves;
+}
+auto PocketSolver::GetDistance(const CubieCube& cube) -> std::optional<uint32_t>
+{
+    auto solution = Solve(cube);
+    if (!solution.has_value())
+        return std::nullopt;
+
+    return solution.value().size();
+}
+
+auto PocketSolver::GetTables() -> const Tables&
+{
+    static const Tables tables = _BuildTables();
+    return tables;
+}
+
+auto PocketSolver::_BuildTables() -> Tables
+{
+    Tables tables;
+    auto load = [&tables](std::string_view name, const auto& build) -> const TableStore::Table& {
+        return tables.Storage.emplace_back(TableStore::Load(name, TABLE_VERSION, build));
+    };
+
+    // a move turns the permutation and the twist independently
+    tables.PermutationMoves = load("pocket_permutation_moves", [] {
+        std::vector<uint16_t> moves(PERMUTATIONS * CubieCube::MOVE_COUNT);
+        for (uint32_t permutation = 0; permutation < PERMUTATIONS; permutation++)
+        {
+            CubieCube cube = StateRank::Unrank2x2(permutation * TWISTS);
+            for (uint32_t move : s_Moves)
+            {
+                CubieCube turned = cube;
+                turned.Multiply(CubieCube::GetMove(move));
+                moves[permutation * CubieCube::MOVE_COUNT + move] = StateRank::Rank2x2(turned) / TWISTS;
+            }
+        }
+
+        return moves;
+    }).As<uint16_t>();
+    tables.TwistMoves = load("pocket_twist_moves", [] {
+        std::vector<uint16_t> moves(TWISTS * CubieCube::MOVE_COUNT);
+        for (uint32_t twist = 0; twist < TWISTS; twist++)
+        {
+            CubieCube cube = StateRank::Unrank2x2(twist);
+            for (uint32_t move : s_Moves)
+            {
+                CubieCube turned = cube;
+                turned.Multiply(CubieCube::GetMove(move));
+                moves[twist * CubieCube::MOVE_COUNT + move] = StateRank::Rank2x2(turned) % TWISTS;
+            }
+        }
+
+        return moves;
+    }).As<uint16_t>();
+
+    // the whole distances fit into nibbles while building, then only their residues are kept
+    tables.Distances = load("pocket_distances", [&tables] {
+        std::vector<uint8_t> distances = TableStore::BuildDistances(StateRank::STATES_2X2, 4, 0, s_Moves, [&tables](uint32_t rank, uint32_t move) {
+            return GetNeighbor(tables, rank, move);
+        });
+
+        std::vector<uint8_t> residues((StateRank::STATES_2X2 + 3) / 4, 0);
+        for (uint32_t rank = 0; rank < StateRank::STATES_2X2; rank++)
+        {
+            uint8_t distance = (distances[rank >> 1] >> ((rank & 1) * 4)) & 0xF;
+            uint8_t value = distance == 0xF ? 3 : distance % 3;
+            residues[rank >> 2] |= value << ((rank & 3) * 2);
+        }
+
+        return residues;
+    }).GetBytes();
+
+    return tables;
+}
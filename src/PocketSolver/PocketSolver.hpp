@@ -0,0 +1,56 @@
+#ifndef POCKETSOLVER_H
+#define POCKETSOLVER_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "TableStore/TableStore.hpp"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Optimal 2x2 solutions from a complete distance table over the ranked states (see StateRank). Only the
+// distance modulo 3 is stored, in 2 bits per state, which is enough to descend greedily: a neighbor one
+// move closer to the solved state is the only kind of neighbor whose value is one less modulo 3.
+class PocketSolver
+{
+public:
+    static constexpr uint32_t PERMUTATIONS = 5040;
+    static constexpr uint32_t TWISTS = 729;
+    static constexpr uint32_t MAX_LENGTH = 11;
+    static constexpr uint32_t TABLE_VERSION = 1;
+
+    // U, U2, U', R, R2, R', F, F2, F', which keep the DBL corner in place
+    static constexpr std::array<uint32_t, 9> s_Moves = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    struct Tables
+    {
+        std::span<const uint16_t> PermutationMoves;
+        std::span<const uint16_t> TwistMoves;
+
+        // the distances modulo 3, four states per byte, 3 for unreachable
+        std::span<const uint8_t> Distances;
+
+        // the stored tables the spans point into
+        std::vector<TableStore::Table> Storage;
+    };
+
+public:
+    // the moves of an optimal solution, the cube is read relative to its DBL corner;
+    // nullopt when the DBL corner is out of place, for a twisted corner or corners that are not a permutation
+    static auto Solve(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>;
+    static auto GetDistance(const CubieCube& cube) -> std::optional<uint32_t>;
+
+    static auto GetTables() -> const Tables&;
+
+    static inline auto GetDistanceModulo3(const Tables& tables, uint32_t rank) -> uint8_t
+    {
+        return (tables.Distances[rank >> 2] >> ((rank & 3) * 2)) & 3;
+    }
+
+private:
+    static auto _BuildTables() -> Tables;
+};
+
+#endif
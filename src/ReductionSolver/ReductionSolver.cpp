@@ -0,0 +1,604 @@
+#include "ReductionSolver.hpp"
+
+#include "CubieCube/CubieCube.hpp"
+#include "TwoPhaseSolver/TwoPhaseSolver.hpp"
+
+#include <algorithm>
+#include <array>
+#include <ranges>
+#include <span>
+#include <utility>
+
+static constexpr uint32_t WINGS = 24;
+static constexpr uint32_t WING_TRIPLES = WINGS * WINGS * WINGS;
+static constexpr uint8_t NO_MOVE = 0xFF;
+
+// the share of the work done once the centers and once the 3x3 stage are solved, the wings take the rest
+static constexpr float CENTERS_PROGRESS = 0.6f;
+static constexpr float CORNERS_PROGRESS = 0.7f;
+
+// the faces in the order of the facelet string and the 3x3 moves
+static constexpr std::array<Face, 6> s_Faces = { Face::Top, Face::Right, Face::Front, Face::Bottom, Face::Left, Face::Back };
+static constexpr std::string_view s_FaceLetters = "URFDLB";
+
+static constexpr std::array<Direction, 3> s_AxisDirections = { Direction::Vertical, Direction::Horizontal, Direction::Depthical };
+
+// a turn of one layer by quarter turns clockwise as seen from the positive side of its axis (x, y or z)
+struct LayerMove
+{
+    uint32_t Axis;
+    uint32_t Layer;
+    uint32_t QuarterTurns;
+
+    inline auto GetInverse() const -> LayerMove { return { Axis, Layer, (4 - QuarterTurns) % 4 }; }
+};
+
+static auto GetFaceSlot(Face face) -> uint32_t
+{
+    return static_cast<uint32_t>(std::ranges::find(s_Faces, face) - s_Faces.begin());
+}
+static auto GetFaceAxis(Face face) -> uint32_t
+{
+    switch (face)
+    {
+    case Face::Right:
+    case Face::Left:
+        return 0;
+    case Face::Top:
+    case Face::Bottom:
+        return 1;
+    case Face::Front:
+    case Face::Back:
+        return 2;
+    case Face::None:
+        break;
+    }
+
+    std::unreachable();
+}
+static auto IsPositiveFace(Face face) -> bool
+{
+    return face == Face::Right || face == Face::Top || face == Face::Front;
+}
+// quarter turns clockwise as seen from the face
+static auto GetFaceMove(Face face, uint32_t size, uint32_t quarterTurns) -> LayerMove
+{
+    if (IsPositiveFace(face))
+        return { GetFaceAxis(face), size - 1, quarterTurns };
+
+    return { GetFaceAxis(face), 0, (4 - quarterTurns) % 4 };
+}
+static auto GetCoordinate(const PieceLocation& location, uint32_t axis) -> uint32_t
+{
+    return axis == 0 ? location.X : axis == 1 ? location.Y : location.Z;
+}
+static auto GetOppositeLetter(char letter) -> char
+{
+    uint32_t slot = static_cast<uint32_t>(s_FaceLetters.find(letter));
+    return s_FaceLetters[(slot + 3) % 6];
+}
+
+// the 24 wings at one depth from the corners, with the 36 face and slice moves that act on them and the
+// shortest setups of any three wing positions from the three the base commutator cycles
+struct WingOrbit
+{
+    // the two facelets of each position, the first one decides its orientation
+    std::vector<std::pair<uint32_t, uint32_t>> Positions;
+
+    std::vector<LayerMove> Moves;
+    // the position the wing at each position goes to, per move
+    std::vector<std::array<uint8_t, WINGS>> MovePositions;
+
+    // cycles the wing at Base[0] to Base[1], that one to Base[2] and that one back to Base[0]
+    std::vector<LayerMove> Commutator;
+    std::array<uint8_t, 3> Base;
+
+    // the last move of a shortest sequence taking the base positions to each triple
+    std::vector<uint8_t> Parents;
+
+    static inline auto GetTriple(uint32_t a, uint32_t b, uint32_t c) -> uint32_t
+    {
+        return (a * WINGS + b) * WINGS + c;
+    }
+};
+
+struct Reduction
+{
+    CubeState State;
+    uint32_t Size;
+    // the color of each face, in the facelet string order
+    std::array<char, 6> Scheme;
+
+    // the moves not streamed yet
+    std::vector<LayerMove> Moves;
+
+    std::stop_token StopToken;
+    const std::function<void(float)>& Progress;
+
+    inline auto Report(float progress) const -> void
+    {
+        if (Progress)
+            Progress(progress);
+    }
+
+    auto GetFacelet(uint32_t facelet, const LayerMove& move) const -> uint32_t
+    {
+        Direction direction = s_AxisDirections[move.Axis];
+        if (move.QuarterTurns == 3)
+            return State.GetFaceletAfterTurn(facelet, { direction, move.Layer, false });
+
+        for (uint32_t i = 0; i < move.QuarterTurns; i++)
+            facelet = State.GetFaceletAfterTurn(facelet, { direction, move.Layer, true });
+
+        return facelet;
+    }
+
+    auto Apply(const LayerMove& move) -> void
+    {
+        if (move.QuarterTurns == 0)
+            return;
+
+        Direction direction = s_AxisDirections[move.Axis];
+        if (move.QuarterTurns == 3)
+            State.ApplyTurn({ direction, move.Layer, false });
+        else
+        {
+            for (uint32_t i = 0; i < move.QuarterTurns; i++)
+                State.ApplyTurn({ direction, move.Layer, true });
+        }
+
+        // consecutive turns of the same layer are merged
+        if (!Moves.empty() && Moves.back().Axis == move.Axis && Moves.back().Layer == move.Layer)
+        {
+            Moves.back().QuarterTurns = (Moves.back().QuarterTurns + move.QuarterTurns) % 4;
+            if (Moves.back().QuarterTurns == 0)
+                Moves.pop_back();
+
+            return;
+        }
+
+        Moves.push_back(move);
+    }
+    auto Apply(std::span<const LayerMove> moves) -> void
+    {
+        for (const LayerMove& move : moves)
+            Apply(move);
+    }
+    auto ApplyInverse(std::span<const LayerMove> moves) -> void
+    {
+        for (const LayerMove& move : moves | std::views::reverse)
+            Apply(move.GetInverse());
+    }
+
+    // the last move may still merge with the next one, it is only taken at the end
+    auto TakeTurns(bool all) -> std::vector<Turn>
+    {
+        size_t count = all || Moves.empty() ? Moves.size() : Moves.size() - 1;
+
+        std::vector<Turn> turns;
+        for (const LayerMove& move : std::span(Moves).first(count))
+        {
+            Direction direction = s_AxisDirections[move.Axis];
+            if (move.QuarterTurns == 3)
+                turns.push_back({ direction, move.Layer, false });
+            else
+                turns.insert(turns.end(), move.QuarterTurns, { direction, move.Layer, true });
+        }
+
+        Moves.erase(Moves.begin(), Moves.begin() + count);
+        return turns;
+    }
+
+    // odd sizes take the colors of their middle centers, even sizes the ones around the DBL corner
+    auto FindScheme() -> bool
+    {
+        const uint32_t last = Size - 1;
+        if (Size % 2 == 1)
+        {
+            for (uint32_t slot = 0; slot < 6; slot++)
+                Scheme[slot] = State.GetFacelet(s_Faces[slot], Size / 2, Size / 2);
+        }
+        else
+        {
+            Scheme[GetFaceSlot(Face::Bottom)] = State.GetFacelet(Face::Bottom, last, 0);
+            Scheme[GetFaceSlot(Face::Left)] = State.GetFacelet(Face::Left, last, 0);
+            Scheme[GetFaceSlot(Face::Back)] = State.GetFacelet(Face::Back, last, last);
+
+            for (Face face : { Face::Bottom, Face::Left, Face::Back })
+            {
+                char color = Scheme[GetFaceSlot(face)];
+                if (s_FaceLetters.find(color) == std::string_view::npos)
+                    return false;
+
+                Scheme[(GetFaceSlot(face) + 3) % 6] = GetOppositeLetter(color);
+            }
+        }
+
+        std::array<char, 6> colors = Scheme;
+        std::ranges::sort(colors);
+        if (std::ranges::adjacent_find(colors) != colors.end())
+            return false;
+
+        // turns already streamed can't be taken back, so states failing later on are kept out here
+        return std::ranges::all_of(colors, [this](char color) {
+            return std::ranges::count(State.GetFacelets(), color) == Size * Size;
+        });
+    }
+
+    auto BuildOrbit(uint32_t depth) const -> WingOrbit
+    {
+        const uint32_t last = Size - 1;
+        WingOrbit orbit;
+
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            for (uint32_t layer : { 0u, last, depth, last - depth })
+            {
+                for (uint32_t quarterTurns = 1; quarterTurns < 4; quarterTurns++)
+                    orbit.Moves.push_back({ axis, layer, quarterTurns });
+            }
+        }
+
+        // the positions in the order the moves reach them from the UF wing at x = depth
+        std::vector<uint8_t> positionByFacelet(6 * Size * Size, NO_MOVE);
+        orbit.Positions.push_back({ State.GetFaceletIndex(Face::Top, last, depth), State.GetFaceletIndex(Face::Front, 0, depth) });
+        positionByFacelet[orbit.Positions[0].first] = 0;
+
+        for (uint32_t position = 0; position < orbit.Positions.size(); position++)
+        {
+            for (const LayerMove& move : orbit.Moves)
+            {
+                auto [first, second] = orbit.Positions[position];
+                uint32_t facelet = GetFacelet(first, move);
+                if (positionByFacelet[facelet] != NO_MOVE)
+                    continue;
+
+                positionByFacelet[facelet] = static_cast<uint8_t>(orbit.Positions.size());
+                orbit.Positions.push_back({ facelet, GetFacelet(second, move) });
+            }
+        }
+
+        orbit.MovePositions.resize(orbit.Moves.size());
+        for (uint32_t move = 0; move < orbit.Moves.size(); move++)
+        {
+            for (uint32_t position = 0; position < WINGS; position++)
+                orbit.MovePositions[move][position] = positionByFacelet[GetFacelet(orbit.Positions[position].first, orbit.Moves[move])];
+        }
+
+        // [slice, U R U'] exchanges a single wing between the two, so it is a 3-cycle
+        orbit.Commutator = {
+            { 0, depth, 1 }, { 1, last, 1 }, { 0, last, 1 }, { 1, last, 3 },
+            { 0, depth, 3 }, { 1, last, 1 }, { 0, last, 3 }, { 1, last, 3 }
+        };
+
+        std::array<uint8_t, WINGS> cycle;
+        for (uint32_t position = 0; position < WINGS; position++)
+            cycle[position] = static_cast<uint8_t>(position);
+        for (const LayerMove& move : orbit.Commutator)
+        {
+            uint32_t index = static_cast<uint32_t>(std::ranges::find_if(orbit.Moves, [&move](const LayerMove& other) {
+                return other.Axis == move.Axis && other.Layer == move.Layer && other.QuarterTurns == move.QuarterTurns;
+            }) - orbit.Moves.begin());
+
+            for (uint8_t& position : cycle)
+                position = orbit.MovePositions[index][position];
+        }
+
+        uint8_t start = 0;
+        while (cycle[start] == start)
+            start++;
+        orbit.Base = { start, cycle[start], cycle[cycle[start]] };
+
+        return orbit;
+    }
+    // breadth-first over the ordered triples of positions
+    auto BuildSetups(WingOrbit& orbit) const -> void
+    {
+        orbit.Parents.assign(WING_TRIPLES, NO_MOVE);
+        std::vector<uint32_t> queue = { WingOrbit::GetTriple(orbit.Base[0], orbit.Base[1], orbit.Base[2]) };
+        orbit.Parents[queue[0]] = static_cast<uint8_t>(orbit.Moves.size());
+
+        for (size_t i = 0; i < queue.size(); i++)
+        {
+            uint32_t a = queue[i] / (WINGS * WINGS), b = queue[i] / WINGS % WINGS, c = queue[i] % WINGS;
+            for (uint32_t move = 0; move < orbit.Moves.size(); move++)
+            {
+                const auto& positions = orbit.MovePositions[move];
+                uint32_t triple = WingOrbit::GetTriple(positions[a], positions[b], positions[c]);
+                if (orbit.Parents[triple] != NO_MOVE)
+                    continue;
+
+                orbit.Parents[triple] = static_cast<uint8_t>(move);
+                queue.push_back(triple);
+            }
+        }
+    }
+
+    // the position each wing belongs to, by the position it is at; nullopt for impossible colors
+    auto GetWingHomes(const WingOrbit& orbit) const -> std::optional<std::array<uint8_t, WINGS>>
+    {
+        std::array<std::pair<char, char>, WINGS> homeColors;
+        for (uint32_t position = 0; position < WINGS; position++)
+        {
+            auto [first, second] = orbit.Positions[position];
+            homeColors[position] = { Scheme[GetFaceSlot(State.GetFaceletFace(first))], Scheme[GetFaceSlot(State.GetFaceletFace(second))] };
+        }
+
+        std::array<uint8_t, WINGS> homes;
+        std::array<bool, WINGS> taken { };
+        for (uint32_t position = 0; position < WINGS; position++)
+        {
+            auto [first, second] = orbit.Positions[position];
+            auto home = std::ranges::find(homeColors, std::pair(State.GetFacelet(first), State.GetFacelet(second)));
+            if (home == homeColors.end() || taken[home - homeColors.begin()])
+                return std::nullopt;
+
+            homes[position] = static_cast<uint8_t>(home - homeColors.begin());
+            taken[homes[position]] = true;
+        }
+
+        return homes;
+    }
+
+    // only even permutations of the wings are left for the 3-cycles, a slice quarter turn is odd on its orbit
+    auto FixWingParity(const WingOrbit& orbit) -> bool
+    {
+        std::optional<std::array<uint8_t, WINGS>> homes = GetWingHomes(orbit);
+        if (!homes.has_value())
+            return false;
+
+        bool odd = false;
+        std::array<bool, WINGS> visited { };
+        for (uint32_t position = 0; position < WINGS; position++)
+        {
+            for (uint32_t next = homes.value()[position]; !visited[position] && next != position; next = homes.value()[next])
+            {
+                visited[next] = true;
+                odd = !odd;
+            }
+
+            visited[position] = true;
+        }
+
+        if (odd)
+            Apply(orbit.Moves[6]);
+
+        return true;
+    }
+
+    // a center commutator moves a sticker of the target color from the source face onto the cell:
+    // [slice, target' slice target], with the two slices parallel and the target face turn between them
+    auto SolveCenter(Face target, uint32_t cell, std::span<const Face> sources) -> bool
+    {
+        const char color = Scheme[GetFaceSlot(target)];
+        const uint32_t targetAxis = GetFaceAxis(target);
+        const PieceLocation location = State.GetFaceletLocation(cell);
+
+        for (Face source : sources)
+        {
+            uint32_t sourceAxis = GetFaceAxis(source);
+            uint32_t axis = sourceAxis == targetAxis ? (targetAxis + 1) % 3 : 3 - targetAxis - sourceAxis;
+            uint32_t layer = GetCoordinate(location, axis);
+
+            // the slice turn bringing the source face onto the target face
+            uint32_t quarterTurns = 1;
+            while (quarterTurns < 4 && State.GetFaceletFace(GetFacelet(cell, { axis, layer, 4 - quarterTurns })) != source)
+                quarterTurns++;
+            if (quarterTurns == 4)
+                continue;
+
+            uint32_t from = GetFacelet(cell, { axis, layer, 4 - quarterTurns });
+            LayerMove sourceMove = GetFaceMove(source, Size, 1);
+            for (uint32_t setup = 0; setup < 4; setup++)
+            {
+                if (State.GetFacelet(GetFacelet(from, { sourceMove.Axis, sourceMove.Layer, (4 - setup * sourceMove.QuarterTurns % 4) % 4 })) != color)
+                    continue;
+
+                LayerMove turn = GetFaceMove(target, Size, 1);
+                uint32_t otherLayer = GetCoordinate(State.GetFaceletLocation(GetFacelet(cell, turn)), axis);
+                if (otherLayer == layer)
+                {
+                    turn = turn.GetInverse();
+                    otherLayer = GetCoordinate(State.GetFaceletLocation(GetFacelet(cell, turn)), axis);
+                }
+
+                LayerMove first { axis, layer, quarterTurns }, second { axis, otherLayer, quarterTurns };
+                Apply({ sourceMove.Axis, sourceMove.Layer, setup * sourceMove.QuarterTurns % 4 });
+                Apply(std::array { first, turn, second, turn.GetInverse(), first.GetInverse(), turn, second.GetInverse(), turn.GetInverse() });
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // a sticker at a time from the faces not built yet
+    auto SolveCenterRow(Face target, uint32_t row, std::span<const Face> sources) -> bool
+    {
+        char color = Scheme[GetFaceSlot(target)];
+        for (uint32_t col = 1; col + 1 < Size; col++)
+        {
+            uint32_t cell = State.GetFaceletIndex(target, row, col);
+            if (State.GetFacelet(cell) == color)
+                continue;
+
+            if (StopToken.stop_requested() || !SolveCenter(target, cell, sources))
+                return false;
+        }
+
+        return true;
+    }
+
+    // the corners and the middle edges as a 3x3 relative to the scheme, the other edges read as solved
+    auto GetCubieCube() const -> std::optional<CubieCube>
+    {
+        const uint32_t last = Size - 1;
+        const std::array<uint32_t, 3> samples = { 0, Size % 2 == 1 ? Size / 2 : 1, last };
+
+        std::array<char, 256> letters;
+        letters.fill('?');
+        for (uint32_t slot = 0; slot < 6; slot++)
+            letters[static_cast<uint8_t>(Scheme[slot])] = s_FaceLetters[slot];
+
+        std::string facelets;
+        for (uint32_t slot = 0; slot < 6; slot++)
+        {
+            for (uint32_t row = 0; row < 3; row++)
+            {
+                for (uint32_t col = 0; col < 3; col++)
+                {
+                    bool corner = row != 1 && col != 1;
+                    if (corner || Size % 2 == 1)
+                        facelets += letters[static_cast<uint8_t>(State.GetFacelet(s_Faces[slot], samples[row], samples[col]))];
+                    else
+                        facelets += s_FaceLetters[slot];
+                }
+            }
+        }
+
+        return CubieCube::FromFacelets(facelets);
+    }
+
+    auto Solve3x3() -> bool
+    {
+        std::optional<CubieCube> cube = GetCubieCube();
+        if (!cube.has_value())
+            return false;
+
+        // the edges of even sizes are read as solved, so the corners have to be an even permutation too
+        if (Size % 2 == 0 && cube->GetCornerParity())
+        {
+            Apply(GetFaceMove(Face::Top, Size, 1));
+            cube = GetCubieCube();
+            if (!cube.has_value())
+                return false;
+        }
+
+        std::optional<std::vector<uint32_t>> solution = TwoPhaseSolver::Solve(*cube);
+        if (!solution.has_value())
+            return false;
+
+        for (uint32_t move : *solution)
+            Apply(GetFaceMove(s_Faces[move / 3], Size, move % 3 + 1));
+
+        return true;
+    }
+
+    auto SolveWings(WingOrbit& orbit) -> bool
+    {
+        if (orbit.Parents.empty())
+            BuildSetups(orbit);
+
+        std::vector<LayerMove> setup;
+        for (uint32_t cycles = 0; cycles < WINGS && !StopToken.stop_requested(); cycles++)
+        {
+            std::optional<std::array<uint8_t, WINGS>> homes = GetWingHomes(orbit);
+            if (!homes.has_value())
+                return false;
+
+            auto isWrong = [&homes](uint32_t position) { return homes.value()[position] != position; };
+            auto wrong = std::ranges::find_if(std::views::iota(0u, WINGS), isWrong);
+            if (wrong == std::views::iota(0u, WINGS).end())
+                return true;
+
+            // the wing at the first position goes home, the one there goes home too unless it belongs to the first
+            uint32_t first = *wrong, second = homes.value()[first], third = homes.value()[second];
+            if (third == first)
+                third = *std::ranges::find_if(std::views::iota(0u, WINGS), [&](uint32_t position) {
+                    return position != first && position != second && isWrong(position);
+                });
+
+            uint32_t triple = WingOrbit::GetTriple(first, second, third);
+            if (orbit.Parents[triple] == NO_MOVE)
+                return false;
+
+            // the setup takes the three positions to the base ones
+            setup.clear();
+            while (orbit.Parents[triple] != orbit.Moves.size())
+            {
+                const LayerMove& move = orbit.Moves[orbit.Parents[triple]];
+                LayerMove inverse = move.GetInverse();
+                setup.push_back(inverse);
+
+                uint32_t index = static_cast<uint32_t>(orbit.Parents[triple]) / 3 * 3 + (inverse.QuarterTurns - 1);
+                const auto& positions = orbit.MovePositions[index];
+                triple = WingOrbit::GetTriple(positions[triple / (WINGS * WINGS)], positions[triple / WINGS % WINGS], positions[triple % WINGS]);
+            }
+
+            Apply(setup);
+            Apply(orbit.Commutator);
+            ApplyInverse(setup);
+        }
+
+        return false;
+    }
+};
+
+auto ReductionSolver::Solve(const CubeState& state, std::stop_token stopToken, const std::function<void(float)>& progress)
+    -> std::optional<std::vector<Turn>>
+{
+    std::vector<Turn> turns;
+    TurnGenerator generator = Stream(state, stopToken, progress);
+    while (std::optional<std::vector<Turn>> batch = generator.Next())
+        turns.insert(turns.end(), batch->begin(), batch->end());
+
+    if (!generator.IsSolved())
+        return std::nullopt;
+
+    return turns;
+}
+auto ReductionSolver::Stream(CubeState state, std::stop_token stopToken, std::function<void(float)> progress) -> TurnGenerator
+{
+    const uint32_t size = state.GetSize();
+    if (size < MIN_SIZE)
+        co_return false;
+
+    Reduction reduction { std::move(state), size, { }, { }, stopToken, progress };
+    if (!reduction.FindScheme())
+        co_return false;
+
+    std::vector<WingOrbit> orbits;
+    for (uint32_t depth = 1; depth < size - 1 - depth; depth++)
+    {
+        orbits.push_back(reduction.BuildOrbit(depth));
+        if (!reduction.FixWingParity(orbits.back()))
+            co_return false;
+    }
+    co_yield reduction.TakeTurns(false);
+
+    // each face in turn, a row at a time; the last face is built by then
+    std::vector<Face> unsolved = { Face::Left, Face::Right, Face::Back, Face::Front, Face::Bottom, Face::Top };
+    while (unsolved.size() > 1)
+    {
+        reduction.Report(CENTERS_PROGRESS * (6 - unsolved.size()) / 5);
+
+        Face target = unsolved.back();
+        unsolved.pop_back();
+        for (uint32_t row = 1; row + 1 < size; row++)
+        {
+            if (!reduction.SolveCenterRow(target, row, unsolved))
+                co_return false;
+
+            co_yield reduction.TakeTurns(false);
+        }
+    }
+    reduction.Report(CENTERS_PROGRESS);
+
+    if (stopToken.stop_requested() || !reduction.Solve3x3())
+        co_return false;
+
+    co_yield reduction.TakeTurns(false);
+    reduction.Report(CORNERS_PROGRESS);
+
+    for (uint32_t i = 0; i < orbits.size(); i++)
+    {
+        if (!reduction.SolveWings(orbits[i]))
+            co_return false;
+
+        co_yield reduction.TakeTurns(false);
+        reduction.Report(CORNERS_PROGRESS + (1.0f - CORNERS_PROGRESS) * (i + 1) / orbits.size());
+    }
+
+    co_yield reduction.TakeTurns(true);
+    co_return reduction.State.IsSolved();
+}
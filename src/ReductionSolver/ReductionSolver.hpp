@@ -0,0 +1,33 @@
+#ifndef REDUCTIONSOLVER_H
+#define REDUCTIONSOLVER_H
+
+#include "CubeState/CubeState.hpp"
+#include "Turn/Turn.hpp"
+#include "TurnGenerator/TurnGenerator.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stop_token>
+#include <vector>
+
+// Solves NxN cubes (N >= 4) by reduction on a CubeState: the parity of every wing orbit is fixed with a
+// slice turn first, the centers are built with center commutators, the corners (and the middle edges of odd
+// sizes) are solved as a 3x3 by the two-phase solver, and the wings are cycled home with wing commutators.
+// Pieces are found through the facelet indices of the state and the precomputed wing orbits, never by
+// scanning the cube for colors.
+class ReductionSolver
+{
+public:
+    static constexpr uint32_t MIN_SIZE = 4;
+
+public:
+    // nullopt for smaller or unsolvable cubes and once a stop is requested; the progress goes from 0 to 1
+    static auto Solve(const CubeState& state, std::stop_token stopToken = { }, const std::function<void(float)>& progress = { })
+        -> std::optional<std::vector<Turn>>;
+    // the same turns in batches, each one as soon as it is decided: the parity turns, every row of the
+    // centers, the 3x3 stage and every wing orbit; solvable states are told apart before the first batch
+    static auto Stream(CubeState state, std::stop_token stopToken = { }, std::function<void(float)> progress = { }) -> TurnGenerator;
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "SolutionCache.hpp"
+
+#include "Symmetry/Symmetry.hpp"
+
+#include <algorithm>
+
+SolutionCache::SolutionCache(size_t capacity)
+    : m_Capacity(std::max<size_t>(capacity, 1)), m_Hits(0), m_Misses(0) { }
+
+auto SolutionCache::Find(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>
+{
+    auto [canonical, symmetry] = Symmetry::Canonicalize3x3(cube);
+    auto moves = _Find(StateRank::Rank3x3(canonical));
+    if (!moves.has_value())
+    {
+        m_Misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    m_Hits.fetch_add(1, std::memory_order_relaxed);
+    return Symmetry::MapSolution(std::vector<uint32_t>(moves->begin(), moves->end()), symmetry);
+}
+auto SolutionCache::Insert(const CubieCube& cube, std::span<const uint32_t> moves) -> void
+{
+    // the moves solving the representative are the conjugates of the ones solving the state
+    auto [canonical, symmetry] = Symmetry::Canonicalize3x3(cube);
+    std::vector<uint8_t> canonicalMoves;
+    canonicalMoves.reserve(moves.size());
+    for (uint32_t move : moves)
+        canonicalMoves.push_back(Symmetry::ConjugateMove(symmetry, move));
+
+    _Insert(StateRank::Rank3x3(canonical), std::move(canonicalMoves));
+}
+auto SolutionCache::Solve(const CubieCube& cube, const std::function<std::optional<std::vector<uint32_t>>(const CubieCube&)>& solve)
+    -> std::optional<std::vector<uint32_t>>
+{
+    auto [canonical, symmetry] = Symmetry::Canonicalize3x3(cube);
+    StateRank::Key key = StateRank::Rank3x3(canonical);
+    if (auto moves = _Find(key))
+    {
+        m_Hits.fetch_add(1, std::memory_order_relaxed);
+        return Symmetry::MapSolution(std::vector<uint32_t>(moves->begin(), moves->end()), symmetry);
+    }
+
+    // two threads missing the same state both solve it, the later insert only refreshes the entry
+    m_Misses.fetch_add(1, std::memory_order_relaxed);
+    auto solution = solve(canonical);
+    if (!solution.has_value())
+        return std::nullopt;
+
+    _Insert(key, std::vector<uint8_t>(solution->begin(), solution->end()));
+    return Symmetry::MapSolution(solution.value(), symmetry);
+}
+
+auto SolutionCache::Clear() -> void
+{
+    std::lock_guard lock(m_Mutex);
+    m_Entries.clear();
+    m_Index.clear();
+    m_Hits.store(0, std::memory_order_relaxed);
+    m_Misses.store(0, std::memory_order_relaxed);
+}
+auto SolutionCache::GetSize() const -> size_t
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Entries.size();
+}
+
+auto SolutionCache::_Find(const StateRank::Key& key) -> std::optional<std::vector<uint8_t>>
+{
+    std::lock_guard lock(m_Mutex);
+    auto it = m_Index.find(key);
+    if (it == m_Index.end())
+        return std::nullopt;
+
+    m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+    return it->second->second;
+}
+auto SolutionCache::_Insert(const StateRank::Key& key, std::vector<uint8_t> moves) -> void
+{
+    std::lock_guard lock(m_Mutex);
+    auto it = m_Index.find(key);
+    if (it != m_Index.end())
+    {
+        m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+        return;
+    }
+
+    if (m_Entries.size() == m_Capacity)
+    {
+        m_Index.erase(m_Entries.back().first);
+        m_Entries.pop_back();
+    }
+
+    m_Entries.emplace_front(key, std::move(moves));
+    m_Index.emplace(key, m_Entries.begin());
+}
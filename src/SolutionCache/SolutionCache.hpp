@@ -0,0 +1,64 @@
+#ifndef SOLUTIONCACHE_H
+#define SOLUTIONCACHE_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "StateRank/StateRank.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A least recently used cache of 3x3 solutions shared between threads. A state is stored as the packed rank of
+// its symmetry class representative (Symmetry::Canonicalize3x3) with the solution of the representative, a move
+// per byte, so the 48 conjugates of a state hit the same entry and get the solution mapped back.
+class SolutionCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 65536;
+
+public:
+    explicit SolutionCache(size_t capacity = DEFAULT_CAPACITY);
+
+    // the stored solution of the state mapped back to it, nullopt on a miss
+    auto Find(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>;
+    // stores the moves solving the state, evicting the least recently used entry when full
+    auto Insert(const CubieCube& cube, std::span<const uint32_t> moves) -> void;
+    // a hit, or the representative solved with solve and stored; solve runs without the lock
+    auto Solve(const CubieCube& cube, const std::function<std::optional<std::vector<uint32_t>>(const CubieCube&)>& solve)
+        -> std::optional<std::vector<uint32_t>>;
+
+    auto Clear() -> void;
+    auto GetSize() const -> size_t;
+    inline auto GetCapacity() const -> size_t { return m_Capacity; }
+    inline auto GetHits() const -> uint64_t { return m_Hits.load(std::memory_order_relaxed); }
+    inline auto GetMisses() const -> uint64_t { return m_Misses.load(std::memory_order_relaxed); }
+
+private:
+    using Entry = std::pair<StateRank::Key, std::vector<uint8_t>>;
+
+private:
+    // the moves of the representative, refreshing the entry
+    auto _Find(const StateRank::Key& key) -> std::optional<std::vector<uint8_t>>;
+    auto _Insert(const StateRank::Key& key, std::vector<uint8_t> moves) -> void;
+
+private:
+    size_t m_Capacity;
+
+    mutable std::mutex m_Mutex;
+    // the most recently used first
+    std::list<Entry> m_Entries;
+    std::unordered_map<StateRank::Key, std::list<Entry>::iterator, StateRank::KeyHash> m_Index;
+
+    std::atomic<uint64_t> m_Hits;
+    std::atomic<uint64_t> m_Misses;
+};
+
+#endif
@@ -0,0 +1,213 @@
+#include "StateRank.hpp"
+
+#include <bit>
+
+static constexpr std::array<uint32_t, 13> s_Factorials = {
+    1, 1, 2, 6, 24, 120, 720, 5040, 40320, 362880, 3628800, 39916800, 479001600
+};
+
+static constexpr uint32_t TWISTS = 2187;
+static constexpr uint32_t FLIPS = 2048;
+static constexpr uint32_t HALF_EDGE_PERMUTATIONS = 239500800;
+
+// the number of set bits of every 12 bit mask, so a Lehmer digit is a single lookup
+static constexpr auto s_BitCounts = [] {
+    std::array<uint8_t, 4096> bitCounts { };
+    for (uint32_t mask = 0; mask < bitCounts.size(); mask++)
+        bitCounts[mask] = std::popcount(mask);
+
+    return bitCounts;
+}();
+
+// the corners of the 2x2 without the DBL corner, which never leaves its slot
+static constexpr std::array<uint8_t, 7> s_FreeCorners = {
+    CubieCube::URF, CubieCube::UFL, CubieCube::ULB, CubieCube::UBR, CubieCube::DFR, CubieCube::DLF, CubieCube::DRB
+};
+
+auto StateRank::KeyHash::operator()(const Key& key) const -> size_t
+{
+    uint64_t low = 0;
+    for (uint32_t i = 0; i < 8; i++)
+        low |= (uint64_t)key.Bytes[i] << (i * 8);
+
+    return std::hash<uint64_t>()(low ^ ((uint64_t)key.Bytes[8] << 56 | key.Bytes[8]));
+}
+
+auto StateRank::Rank2x2(const CubieCube& cube) -> uint32_t
+{
+    std::array<uint8_t, 7> permutation, orientation;
+    for (uint32_t i = 0; i < 7; i++)
+    {
+        uint8_t corner = cube.CornerPermutation[s_FreeCorners[i]];
+        permutation[i] = corner == CubieCube::DRB ? 6 : corner;
+        orientation[i] = cube.CornerOrientation[s_FreeCorners[i]];
+    }
+
+    return RankPermutation(permutation) * 729 + RankTwist(orientation);
+}
+auto StateRank::Unrank2x2(uint32_t rank) -> CubieCube
+{
+    std::array<uint8_t, 7> permutation, orientation;
+    UnrankPermutation(rank / 729, permutation);
+    UnrankTwist(rank % 729, orientation);
+
+    CubieCube cube = CubieCube::Solved();
+    for (uint32_t i = 0; i < 7; i++)
+    {
+        cube.CornerPermutation[s_FreeCorners[i]] = s_FreeCorners[permutation[i]];
+        cube.CornerOrientation[s_FreeCorners[i]] = orientation[i];
+    }
+
+    return cube;
+}
+auto StateRank::Rank2x2(const Cube& cube) -> std::optional<uint32_t>
+{
+    if (cube.GetSize() != 2)
+        return std::nullopt;
+
+    auto cubieCube = CubieCube::FromCube(cube);
+    if (!cubieCube.has_value())
+        return std::nullopt;
+
+    return Rank2x2(cubieCube.value());
+}
+auto StateRank::Unrank2x2(Cube& cube, uint32_t rank) -> void
+{
+    if (cube.GetSize() != 2)
+        cube.SetSize(2);
+
+    Unrank2x2(rank).ApplyTo(cube);
+}
+
+auto StateRank::Rank3x3(const CubieCube& cube) -> Key
+{
+    // the edge permutation has the parity of the corner permutation, and the last Lehmer digit of
+    // weight 1! is exactly the one swapping the last two edges, so halving the rank drops it
+    __extension__ using uint128_t = unsigned __int128;
+
+    uint128_t rank = RankPermutation(cube.CornerPermutation);
+    rank = rank * TWISTS + RankTwist(cube.CornerOrientation);
+    rank = rank * HALF_EDGE_PERMUTATIONS + RankPermutation(cube.EdgePermutation) / 2;
+    rank = rank * FLIPS + RankFlip(cube.EdgeOrientation);
+
+    Key key;
+    for (uint32_t i = 0; i < key.Bytes.size(); i++)
+        key.Bytes[i] = (uint8_t)(rank >> (i * 8));
+
+    return key;
+}
+auto StateRank::Unrank3x3(const Key& key) -> CubieCube
+{
+    __extension__ using uint128_t = unsigned __int128;
+
+    uint128_t rank = 0;
+    for (uint32_t i = 0; i < key.Bytes.size(); i++)
+        rank |= (uint128_t)key.Bytes[i] << (i * 8);
+
+    CubieCube cube;
+    UnrankFlip(rank % FLIPS, cube.EdgeOrientation);
+    rank /= FLIPS;
+    UnrankPermutation(rank % HALF_EDGE_PERMUTATIONS * 2, cube.EdgePermutation);
+    rank /= HALF_EDGE_PERMUTATIONS;
+    UnrankTwist(rank % TWISTS, cube.CornerOrientation);
+    UnrankPermutation(rank / TWISTS, cube.CornerPermutation);
+
+    if (cube.GetEdgeParity() != cube.GetCornerParity())
+        std::swap(cube.EdgePermutation[10], cube.EdgePermutation[11]);
+
+    return cube;
+}
+auto StateRank::Rank3x3(const Cube& cube) -> std::optional<Key>
+{
+    if (cube.GetSize() != 3)
+        return std::nullopt;
+
+    auto cubieCube = CubieCube::FromCube(cube);
+    if (!cubieCube.has_value())
+        return std::nullopt;
+
+    return Rank3x3(cubieCube.value());
+}
+auto StateRank::Unrank3x3(Cube& cube, const Key& key) -> void
+{
+    if (cube.GetSize() != 3)
+        cube.SetSize(3);
+
+    Unrank3x3(key).ApplyTo(cube);
+}
+
+auto StateRank::RankPermutation(std::span<const uint8_t> permutation) -> uint32_t
+{
+    const uint32_t size = permutation.size();
+
+    uint32_t rank = 0;
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        // the digit is the number of smaller elements that are still unused
+        uint32_t element = permutation[i];
+        rank += (element - s_BitCounts[seen & ((1u << element) - 1)]) * s_Factorials[size - 1 - i];
+        seen |= 1u << element;
+    }
+
+    return rank;
+}
+auto StateRank::UnrankPermutation(uint32_t rank, std::span<uint8_t> permutation) -> void
+{
+    const uint32_t size = permutation.size();
+
+    uint32_t unused = (1u << size) - 1;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        uint32_t digit = rank / s_Factorials[size - 1 - i];
+        rank %= s_Factorials[size - 1 - i];
+
+        // drop the lowest unused elements until the digit-th one is the lowest
+        uint32_t remaining = unused;
+        for (uint32_t j = 0; j < digit; j++)
+            remaining &= remaining - 1;
+
+        uint32_t element = std::countr_zero(remaining);
+        permutation[i] = element;
+        unused &= ~(1u << element);
+    }
+}
+
+auto StateRank::RankTwist(std::span<const uint8_t> orientation) -> uint32_t
+{
+    uint32_t rank = 0;
+    for (uint32_t i = 0; i + 1 < orientation.size(); i++)
+        rank = rank * 3 + orientation[i];
+
+    return rank;
+}
+auto StateRank::UnrankTwist(uint32_t rank, std::span<uint8_t> orientation) -> void
+{
+    uint32_t sum = 0;
+    for (uint32_t i = orientation.size() - 1; i-- > 0;)
+    {
+        orientation[i] = rank % 3;
+        sum += orientation[i];
+        rank /= 3;
+    }
+    orientation.back() = (3 - sum % 3) % 3;
+}
+auto StateRank::RankFlip(std::span<const uint8_t> orientation) -> uint32_t
+{
+    uint32_t rank = 0;
+    for (uint32_t i = 0; i + 1 < orientation.size(); i++)
+        rank = rank * 2 + orientation[i];
+
+    return rank;
+}
+auto StateRank::UnrankFlip(uint32_t rank, std::span<uint8_t> orientation) -> void
+{
+    uint32_t sum = 0;
+    for (uint32_t i = orientation.size() - 1; i-- > 0;)
+    {
+        orientation[i] = rank % 2;
+        sum += orientation[i];
+        rank /= 2;
+    }
+    orientation.back() = sum % 2;
+}
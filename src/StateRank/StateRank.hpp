@@ -0,0 +1,55 @@
+#ifndef STATERANK_H
+#define STATERANK_H
+
+#include "Cube/Cube.hpp"
+#include "CubieCube/CubieCube.hpp"
+
+#include <array>
+#include <optional>
+#include <span>
+
+// Perfect ranks of the reachable 2x2 and 3x3 states:
+//  2x2: 7! * 3^6 = 3,674,160 states (the DBL corner is the reference) in 22 bits
+//  3x3: 8! * 3^7 * 12! / 2 * 2^11 ~ 4.3 * 10^19 states in 66 bits
+class StateRank
+{
+public:
+    static constexpr uint32_t STATES_2X2 = 3674160;
+
+    // the 66 bit rank of a 3x3 state, little endian
+    struct Key
+    {
+        std::array<uint8_t, 9> Bytes;
+
+        auto operator==(const Key& other) const -> bool = default;
+        auto operator<=>(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+        auto operator()(const Key& key) const -> size_t;
+    };
+
+public:
+    static auto Rank2x2(const CubieCube& cube) -> uint32_t;
+    static auto Unrank2x2(uint32_t rank) -> CubieCube;
+    static auto Rank2x2(const Cube& cube) -> std::optional<uint32_t>;
+    static auto Unrank2x2(Cube& cube, uint32_t rank) -> void;
+
+    static auto Rank3x3(const CubieCube& cube) -> Key;
+    static auto Unrank3x3(const Key& key) -> CubieCube;
+    static auto Rank3x3(const Cube& cube) -> std::optional<Key>;
+    static auto Unrank3x3(Cube& cube, const Key& key) -> void;
+
+    // Lehmer code of a permutation of 0..n-1 (n <= 12) and back
+    static auto RankPermutation(std::span<const uint8_t> permutation) -> uint32_t;
+    static auto UnrankPermutation(uint32_t rank, std::span<uint8_t> permutation) -> void;
+
+    // base 3 / base 2 digits of all but the last piece, which is implied by the others
+    static auto RankTwist(std::span<const uint8_t> orientation) -> uint32_t;
+    static auto UnrankTwist(uint32_t rank, std::span<uint8_t> orientation) -> void;
+    static auto RankFlip(std::span<const uint8_t> orientation) -> uint32_t;
+    static auto UnrankFlip(uint32_t rank, std::span<uint8_t> orientation) -> void;
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "Symmetry.hpp"
+
+#include <compare>
+#include <ranges>
+
+using enum CubieCube::Corner;
+using enum CubieCube::Edge;
+
+// the generators: a 120 degree turn around the URF-DBL diagonal, a half turn around F,
+// a quarter turn around U and the reflection through the plane between L and R
+static const CubieCube s_RotationURF3 = {
+    { URF, DFR, DLF, UFL, UBR, DRB, DBL, ULB }, { 1, 2, 1, 2, 2, 1, 2, 1 },
+    { UF, FR, DF, FL, UB, BR, DB, BL, UR, DR, DL, UL }, { 1, 0, 1, 0, 1, 0, 1, 0, 1, 1, 1, 1 }
+};
+static const CubieCube s_RotationF2 = {
+    { DLF, DFR, DRB, DBL, UFL, URF, UBR, ULB }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { DL, DF, DR, DB, UL, UF, UR, UB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+static const CubieCube s_RotationU4 = {
+    { UBR, URF, UFL, ULB, DRB, DFR, DLF, DBL }, { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { UB, UR, UF, UL, DB, DR, DF, DL, BR, FR, FL, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1 }
+};
+static const CubieCube s_MirrorLR2 = {
+    { UFL, URF, UBR, ULB, DLF, DFR, DRB, DBL }, { 3, 3, 3, 3, 3, 3, 3, 3 },
+    { UL, UF, UR, UB, DL, DF, DR, DB, FL, FR, BR, BL }, { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+};
+
+auto Symmetry::Conjugate(const CubieCube& cube, uint32_t symmetry) -> CubieCube
+{
+    CubieCube result;
+    _ConjugateCorners(cube, symmetry, result);
+    _ConjugateEdges(cube, symmetry, result);
+
+    return result;
+}
+
+auto Symmetry::Canonicalize3x3(const CubieCube& cube) -> std::pair<CubieCube, uint32_t>
+{
+    const Tables& tables = _GetTables();
+
+    CubieCube best = cube;
+    uint32_t bestSymmetry = 0;
+
+    CubieCube candidate;
+    for (uint32_t symmetry = 1; symmetry < COUNT; symmetry++)
+    {
+        // most candidates already lose on the first corners, so the rest is only conjugated when needed
+        const CubieCube& s = tables.Symmetries[symmetry];
+        const CubieCube& inverse = tables.Symmetries[tables.Inverses[symmetry]];
+
+        std::strong_ordering order = std::strong_ordering::equal;
+        for (uint32_t i = 0; i < 8 && order == 0; i++)
+        {
+            candidate.CornerPermutation[i] = s.CornerPermutation[cube.CornerPermutation[inverse.CornerPermutation[i]]];
+            order = candidate.CornerPermutation[i] <=> best.CornerPermutation[i];
+        }
+        if (order > 0)
+            continue;
+
+        _ConjugateCorners(cube, symmetry, candidate);
+        if (order == 0 && (order = candidate.CornerOrientation <=> best.CornerOrientation) > 0)
+            continue;
+
+        _ConjugateEdges(cube, symmetry, candidate);
+        if (order < 0 || std::tie(candidate.EdgePermutation, candidate.EdgeOrientation) < std::tie(best.EdgePermutation, best.EdgeOrientation))
+        {
+            best = candidate;
+            bestSymmetry = symmetry;
+        }
+    }
+
+    return { best, bestSymmetry };
+}
+auto Symmetry::Canonicalize2x2(const CubieCube& cube) -> std::pair<CubieCube, uint32_t>
+{
+    const Tables& tables = _GetTables();
+
+    CubieCube best = CubieCube::Solved();
+    uint32_t bestSymmetry = COUNT;
+
+    CubieCube conjugate = CubieCube::Solved(), candidate = CubieCube::Solved();
+    for (uint32_t symmetry = 0; symmetry < COUNT; symmetry++)
+    {
+        _ConjugateCorners(cube, symmetry, conjugate);
+
+        const CubieCube& relabel = tables.Symmetries[tables.CornerRelabels[conjugate.CornerPermutation[DBL]][conjugate.CornerOrientation[DBL]]];
+        for (uint32_t i = 0; i < 8; i++)
+        {
+            candidate.CornerPermutation[i] = relabel.CornerPermutation[conjugate.CornerPermutation[i]];
+            candidate.CornerOrientation[i] = CubieCube::s_OrientationProducts[relabel.CornerOrientation[conjugate.CornerPermutation[i]]][conjugate.CornerOrientation[i]];
+        }
+
+        if (bestSymmetry == COUNT || std::tie(candidate.CornerPermutation, candidate.CornerOrientation) < std::tie(best.CornerPermutation, best.CornerOrientation))
+        {
+            best = candidate;
+            bestSymmetry = symmetry;
+        }
+    }
+
+    return { best, bestSymmetry };
+}
+
+auto Symmetry::MapSolution(std::span<const uint32_t> moves, uint32_t symmetry) -> std::vector<uint32_t>
+{
+    // c = S^-1 * canonical * S, so every move m of the solution becomes S^-1 * m * S
+    uint32_t inverse = GetInverse(symmetry);
+
+    std::vector<uint32_t> mapped;
+    mapped.reserve(moves.size());
+    for (uint32_t move : moves)
+        mapped.push_back(ConjugateMove(inverse, move));
+
+    return mapped;
+}
+auto Symmetry::MapSolution(std::string_view moves, uint32_t symmetry) -> std::string
+{
+    uint32_t inverse = GetInverse(symmetry);
+
+    std::string mapped;
+    for (auto token : moves | std::views::split(' '))
+    {
+        std::string_view move(token.begin(), token.end());
+        if (move.empty())
+            continue;
+
+        if (!mapped.empty())
+            mapped += ' ';
+
+        auto index = CubieCube::GetMoveIndex(move);
+        if (index.has_value())
+            mapped += CubieCube::GetMoveName(ConjugateMove(inverse, index.value()));
+        else
+            mapped += move;
+    }
+
+    return mapped;
+}
+
+auto Symmetry::_GetTables() -> const Tables&
+{
+    static const Tables tables = [] {
+        Tables tables;
+
+        // symmetry = 16 * urf3 + 8 * f2 + 2 * u4 + lr2
+        CubieCube symmetry = CubieCube::Solved();
+        uint32_t index = 0;
+        for (uint32_t urf3 = 0; urf3 < 3; urf3++)
+        {
+            for (uint32_t f2 = 0; f2 < 2; f2++)
+            {
+                for (uint32_t u4 = 0; u4 < 4; u4++)
+                {
+                    for (uint32_t lr2 = 0; lr2 < 2; lr2++)
+                    {
+                        tables.Symmetries[index++] = symmetry;
+                        symmetry.Multiply(s_MirrorLR2);
+                    }
+                    symmetry.Multiply(s_RotationU4);
+                }
+                symmetry.Multiply(s_RotationF2);
+            }
+            symmetry.Multiply(s_RotationURF3);
+        }
+
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            for (uint32_t j = 0; j < COUNT; j++)
+            {
+                CubieCube product = tables.Symmetries[i];
+                product.Multiply(tables.Symmetries[j]);
+                if (product == CubieCube::Solved())
+                    tables.Inverses[i] = j;
+            }
+        }
+
+        for (uint32_t i = 0; i < COUNT; i++)
+        {
+            for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+            {
+                CubieCube conjugate = tables.Symmetries[i];
+                conjugate.Multiply(CubieCube::GetMove(move));
+                conjugate.Multiply(tables.Symmetries[tables.Inverses[i]]);
+
+                for (uint32_t other = 0; other < CubieCube::MOVE_COUNT; other++)
+                    if (conjugate == CubieCube::GetMove(other))
+                        tables.ConjugatedMoves[i][move] = other;
+            }
+        }
+
+        // the even symmetries are the 24 rotations
+        for (uint32_t i = 0; i < COUNT; i += 2)
+        {
+            const CubieCube& rotation = tables.Symmetries[i];
+            for (uint32_t corner = 0; corner < 8; corner++)
+                if (rotation.CornerPermutation[corner] == DBL)
+                    tables.CornerRelabels[corner][(3 - rotation.CornerOrientation[corner]) % 3] = i;
+        }
+
+        return tables;
+    }();
+
+    return tables;
+}
+auto Symmetry::_ConjugateCorners(const CubieCube& cube, uint32_t symmetry, CubieCube& result) -> void
+{
+    const Tables& tables = _GetTables();
+    const CubieCube& s = tables.Symmetries[symmetry];
+    const CubieCube& inverse = tables.Symmetries[tables.Inverses[symmetry]];
+
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        uint32_t j = inverse.CornerPermutation[i];
+        uint8_t orientation = CubieCube::s_OrientationProducts[s.CornerOrientation[cube.CornerPermutation[j]]][cube.CornerOrientation[j]];
+
+        result.CornerPermutation[i] = s.CornerPermutation[cube.CornerPermutation[j]];
+        result.CornerOrientation[i] = CubieCube::s_OrientationProducts[orientation][inverse.CornerOrientation[i]];
+    }
+}
+auto Symmetry::_ConjugateEdges(const CubieCube& cube, uint32_t symmetry, CubieCube& result) -> void
+{
+    const Tables& tables = _GetTables();
+    const CubieCube& s = tables.Symmetries[symmetry];
+    const CubieCube& inverse = tables.Symmetries[tables.Inverses[symmetry]];
+
+    for (uint32_t i = 0; i < 12; i++)
+    {
+        uint32_t j = inverse.EdgePermutation[i];
+        result.EdgePermutation[i] = s.EdgePermutation[cube.EdgePermutation[j]];
+        result.EdgeOrientation[i] = s.EdgeOrientation[cube.EdgePermutation[j]] ^ cube.EdgeOrientation[j] ^ inverse.EdgeOrientation[i];
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SYMMETRY_H
+#define SYMMETRY_H
+
+#include "CubieCube/CubieCube.hpp"
+
+#include <array>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// The 48 rotations and reflections of the cube. Conjugating a state by one of them (S * c * S^-1) looks
+// at it from another side with the colors relabelled, so every state of a symmetry class is solved by
+// equally long solutions and a search needs to know only one canonical representative.
+class Symmetry
+{
+public:
+    static constexpr uint32_t COUNT = 48;
+
+public:
+    static auto Conjugate(const CubieCube& cube, uint32_t symmetry) -> CubieCube;
+
+    // the conjugate with the lexicographically smallest cubie arrays and the symmetry that produced it
+    static auto Canonicalize3x3(const CubieCube& cube) -> std::pair<CubieCube, uint32_t>;
+    // the DBL corner is put back in place by relabelling the colors, which keeps a 2x2 solvable
+    // by the same moves up to a whole cube rotation
+    static auto Canonicalize2x2(const CubieCube& cube) -> std::pair<CubieCube, uint32_t>;
+
+    // turns moves solving the canonical state into moves solving the state it came from
+    static auto MapSolution(std::span<const uint32_t> moves, uint32_t symmetry) -> std::vector<uint32_t>;
+    static auto MapSolution(std::string_view moves, uint32_t symmetry) -> std::string;
+
+    static inline auto GetSymmetry(uint32_t symmetry) -> const CubieCube& { return _GetTables().Symmetries[symmetry]; }
+    static inline auto GetInverse(uint32_t symmetry) -> uint32_t { return _GetTables().Inverses[symmetry]; }
+    // the move S * m * S^-1
+    static inline auto ConjugateMove(uint32_t symmetry, uint32_t move) -> uint32_t { return _GetTables().ConjugatedMoves[symmetry][move]; }
+
+private:
+    struct Tables
+    {
+        std::array<CubieCube, COUNT> Symmetries;
+        std::array<uint32_t, COUNT> Inverses;
+        std::array<std::array<uint32_t, CubieCube::MOVE_COUNT>, COUNT> ConjugatedMoves;
+        // the rotation relabelling the given corner with the given twist as the solved DBL corner
+        std::array<std::array<uint32_t, 3>, 8> CornerRelabels;
+    };
+
+private:
+    static auto _GetTables() -> const Tables&;
+    static auto _ConjugateCorners(const CubieCube& cube, uint32_t symmetry, CubieCube& result) -> void;
+    static auto _ConjugateEdges(const CubieCube& cube, uint32_t symmetry, CubieCube& result) -> void;
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "TableStore.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+    #define TABLESTORE_MMAP 0
+#else
+    #define TABLESTORE_MMAP 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static constexpr std::array<char, 8> s_Magic = { 'R', 'U', 'B', 'I', 'X', 'T', 'B', 'L' };
+
+struct FileHeader
+{
+    std::array<char, 8> Magic;
+    uint32_t FormatVersion;
+    uint32_t TableVersion;
+    uint64_t Size;
+    uint64_t Checksum;
+};
+
+static std::mutex s_DirectoryMutex;
+
+static auto GetDirectoryStorage() -> std::filesystem::path&
+{
+    static std::filesystem::path directory = [] {
+        const char* environment = std::getenv("RUBIX_TABLES");
+        return std::filesystem::path(environment != nullptr && *environment != '\0' ? environment : "tables");
+    }();
+    return directory;
+}
+
+// an empty table is a failed build, never a cached one
+static auto IsValidHeader(const FileHeader& header, uint32_t version, uint64_t dataSize) -> bool
+{
+    return dataSize > 0 && header.Magic == s_Magic && header.FormatVersion == TableStore::FORMAT_VERSION &&
+        header.TableVersion == version && header.Size == dataSize;
+}
+
+TableStore::Table::Table(std::vector<uint8_t> memory)
+    : m_Memory(std::move(memory))
+{
+    m_Data = m_Memory.data();
+    m_Size = m_Memory.size();
+}
+TableStore::Table::~Table()
+{
+    _Release();
+}
+
+TableStore::Table::Table(Table&& other) noexcept
+{
+    *this = std::move(other);
+}
+auto TableStore::Table::operator=(Table&& other) noexcept -> Table&
+{
+    if (this == &other)
+        return *this;
+
+    _Release();
+
+    // the data of a moved vector stays where it is
+    m_Memory = std::move(other.m_Memory);
+    m_Data = std::exchange(other.m_Data, nullptr);
+    m_Size = std::exchange(other.m_Size, 0);
+    m_Mapping = std::exchange(other.m_Mapping, nullptr);
+    m_MappingSize = std::exchange(other.m_MappingSize, 0);
+
+    return *this;
+}
+
+auto TableStore::Table::_Release() -> void
+{
+#if TABLESTORE_MMAP
+    if (m_Mapping != nullptr)
+        munmap(m_Mapping, m_MappingSize);
+#endif
+
+    m_Mapping = nullptr;
+    m_MappingSize = 0;
+    m_Memory.clear();
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+auto TableStore::SetDirectory(const std::filesystem::path& directory) -> void
+{
+    std::lock_guard lock(s_DirectoryMutex);
+    GetDirectoryStorage() = directory;
+}
+auto TableStore::GetDirectory() -> std::filesystem::path
+{
+    std::lock_guard lock(s_DirectoryMutex);
+    return GetDirectoryStorage();
+}
+
+// FNV-1a over 64 bit words
+auto TableStore::GetChecksum(std::span<const uint8_t> data) -> uint64_t
+{
+    constexpr uint64_t PRIME = 0x100000001B3;
+
+    uint64_t checksum = 0xCBF29CE484222325;
+    size_t words = data.size() / 8;
+    for (size_t i = 0; i < words; i++)
+    {
+        uint64_t word;
+        std::memcpy(&word, data.data() + i * 8, 8);
+        checksum = (checksum ^ word) * PRIME;
+    }
+    for (size_t i = words * 8; i < data.size(); i++)
+        checksum = (checksum ^ data[i]) * PRIME;
+
+    return checksum ^ data.size();
+}
+
+auto TableStore::PackDistancesMod3(std::span<const uint8_t> distances, uint32_t size) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> packed((size + 3) / 4, 0);
+    for (uint32_t index = 0; index < size; index++)
+    {
+        uint8_t distance = (distances[index >> 1] >> ((index & 1) * 4)) & 0xF;
+        packed[index >> 2] |= distance % 3 << ((index & 3) * 2);
+    }
+
+    return packed;
+}
+
+auto TableStore::Open(std::string_view name, uint32_t version) -> std::optional<Table>
+{
+    Table table = _Map(_GetPath(name), version);
+    if (table.m_Data == nullptr)
+        return std::nullopt;
+
+    return table;
+}
+
+auto TableStore::_GetPath(std::string_view name) -> std::filesystem::path
+{
+    return GetDirectory() / (std::string(name) + ".tbl");
+}
+auto TableStore::_Load(std::string_view name, uint32_t version, const std::function<std::vector<uint8_t>()>& build) -> Table
+{
+    std::filesystem::path path = _GetPath(name);
+
+    Table table = _Map(path, version);
+    if (table.m_Data != nullptr)
+        return table;
+
+    // a missing directory or a read-only one only costs the rebuild on the next start
+    std::vector<uint8_t> data = build();
+    if (_Write(path, version, data))
+    {
+        table = _Map(path, version);
+        if (table.m_Data != nullptr)
+            return table;
+    }
+
+    return Table(std::move(data));
+}
+
+auto TableStore::_Map(const std::filesystem::path& path, uint32_t version) -> Table
+{
+    Table table;
+
+#if TABLESTORE_MMAP
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return table;
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || (size_t)status.st_size < sizeof(FileHeader))
+    {
+        close(file);
+        return table;
+    }
+
+    size_t mappingSize = status.st_size;
+    void* mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, file, 0);
+    close(file);
+    if (mapping == MAP_FAILED)
+        return table;
+
+    table.m_Mapping = mapping;
+    table.m_MappingSize = mappingSize;
+
+    FileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    std::span<const uint8_t> data(static_cast<const uint8_t*>(mapping) + sizeof(FileHeader), mappingSize - sizeof(FileHeader));
+    if (!IsValidHeader(header, version, data.size()) || GetChecksum(data) != header.Checksum)
+    {
+        table._Release();
+        return table;
+    }
+
+    table.m_Data = data.data();
+    table.m_Size = data.size();
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return table;
+
+    size_t fileSize = file.tellg();
+    if (fileSize < sizeof(FileHeader))
+        return table;
+
+    FileHeader header;
+    std::vector<uint8_t> data(fileSize - sizeof(FileHeader));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    file.read(reinterpret_cast<char*>(data.data()), data.size());
+    if (!file || !IsValidHeader(header, version, data.size()) || GetChecksum(data) != header.Checksum)
+        return table;
+
+    table = Table(std::move(data));
+#endif
+
+    return table;
+}
+
+auto TableStore::_Write(const std::filesystem::path& path, uint32_t version, std::span<const uint8_t> data) -> bool
+{
+    if (data.empty())
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // written aside and renamed, so other processes never map a partial file
+    std::filesystem::path temporaryPath = path;
+    temporaryPath += "." + std::to_string(std::random_device()()) + ".tmp";
+
+    FileHeader header {
+        .Magic = s_Magic,
+        .FormatVersion = FORMAT_VERSION,
+        .TableVersion = version,
+        .Size = data.size(),
+        .Checksum = GetChecksum(data)
+    };
+
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporaryPath, path, error);
+    if (error)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,167 @@
+#ifndef TABLESTORE_H
+#define TABLESTORE_H
+
+#include "JobSystem/JobSystem.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Builds the move and pruning tables of the solvers once and keeps them in files: a header with the format
+// and table versions, the size and a checksum, then the raw data. Later runs map the files read-only, so a
+// cold start only costs the checksum and processes on the same host share the pages.
+class TableStore
+{
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint8_t UNKNOWN_DISTANCE = 0xFF;
+
+    // a read-only table, mapped from its file or held in memory when the file could not be used
+    class Table
+    {
+    public:
+        Table() = default;
+        explicit Table(std::vector<uint8_t> memory);
+        ~Table();
+
+        Table(Table&& other) noexcept;
+        auto operator=(Table&& other) noexcept -> Table&;
+        Table(const Table&) = delete;
+        auto operator=(const Table&) -> Table& = delete;
+
+        inline auto GetBytes() const -> std::span<const uint8_t> { return { m_Data, m_Size }; }
+        inline auto IsMapped() const -> bool { return m_Mapping != nullptr; }
+
+        template<typename T>
+        inline auto As() const -> std::span<const T> { return { reinterpret_cast<const T*>(m_Data), m_Size / sizeof(T) }; }
+
+    private:
+        friend class TableStore;
+
+        auto _Release() -> void;
+
+    private:
+        const uint8_t* m_Data = nullptr;
+        size_t m_Size = 0;
+
+        void* m_Mapping = nullptr;
+        size_t m_MappingSize = 0;
+        std::vector<uint8_t> m_Memory;
+    };
+
+public:
+    // maps the table from its file, or builds it and writes the file first when it is missing, stale or corrupt;
+    // build returns a vector of any trivially copyable type
+    static auto Load(std::string_view name, uint32_t version, const auto& build) -> Table
+    {
+        return _Load(name, version, [&build] {
+            auto table = build();
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(table.data());
+            return std::vector<uint8_t>(bytes, bytes + table.size() * sizeof(table[0]));
+        });
+    }
+
+    // maps the table from its file without ever building it, nullopt when the file is missing, stale or corrupt
+    static auto Open(std::string_view name, uint32_t version) -> std::optional<Table>;
+
+    // the directory of the files, $RUBIX_TABLES or ./tables by default
+    static auto SetDirectory(const std::filesystem::path& directory) -> void;
+    static auto GetDirectory() -> std::filesystem::path;
+
+    static auto GetChecksum(std::span<const uint8_t> data) -> uint64_t;
+
+    // breadth first search over the coordinates [0, size) from the solved one, level by level on the job
+    // system: a level expands the entries of the last one forward while they are few, and checks the unknown
+    // entries for a neighbor in the last level once most of the table is known. The distances are stored in
+    // bits = 4 or 8 bits per entry, the all-ones value marking the unreachable ones.
+    static auto BuildDistances(uint32_t size, uint32_t bits, uint32_t solved, std::span<const uint32_t> moves, const auto& getNeighbor)
+        -> std::vector<uint8_t>
+    {
+        const uint8_t unknown = (1u << bits) - 1;
+        const uint32_t entriesPerByte = 8 / bits;
+
+        std::vector<uint8_t> distances((size + entriesPerByte - 1) / entriesPerByte, 0xFF);
+        auto getDistance = [&distances, bits](uint32_t index) -> uint8_t {
+            if (bits == 8)
+                return std::atomic_ref(distances[index]).load(std::memory_order_relaxed);
+
+            return (std::atomic_ref(distances[index >> 1]).load(std::memory_order_relaxed) >> ((index & 1) * 4)) & 0xF;
+        };
+        // sets an unknown entry and tells whether it was still unknown
+        auto setDistance = [&distances, bits, unknown](uint32_t index, uint8_t distance) -> bool {
+            if (bits == 8)
+                return std::atomic_ref(distances[index]).exchange(distance, std::memory_order_relaxed) == unknown;
+
+            uint32_t shift = (index & 1) * 4;
+            uint8_t previous = std::atomic_ref(distances[index >> 1]).fetch_and((uint8_t)~((unknown ^ distance) << shift), std::memory_order_relaxed);
+            return ((previous >> shift) & 0xF) == unknown;
+        };
+
+        setDistance(solved, 0);
+
+        // whole bytes per chunk, so no two chunks write the same entry
+        constexpr uint32_t CHUNK_SIZE = 1 << 16;
+        uint32_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        uint64_t filled = 1;
+        std::atomic<uint64_t> lastLevel = 1;
+        for (uint8_t depth = 0; lastLevel > 0 && depth + 1 < unknown; depth++)
+        {
+            bool backward = filled > size / 2;
+            lastLevel = 0;
+            JobSystem::Get().ParallelFor(0, chunks, 1, [&](uint32_t firstChunk, uint32_t lastChunk) {
+                uint64_t found = 0;
+                uint32_t end = std::min<uint64_t>((uint64_t)lastChunk * CHUNK_SIZE, size);
+                for (uint32_t index = firstChunk * CHUNK_SIZE; index < end; index++)
+                {
+                    uint8_t distance = getDistance(index);
+                    if (backward)
+                    {
+                        if (distance != unknown)
+                            continue;
+
+                        for (uint32_t move : moves)
+                        {
+                            if (getDistance(getNeighbor(index, move)) == depth)
+                            {
+                                found += setDistance(index, depth + 1);
+                                break;
+                            }
+                        }
+                    }
+                    else if (distance == depth)
+                    {
+                        for (uint32_t move : moves)
+                        {
+                            uint32_t neighbor = getNeighbor(index, move);
+                            if (getDistance(neighbor) == unknown)
+                                found += setDistance(neighbor, depth + 1);
+                        }
+                    }
+                }
+                lastLevel += found;
+            });
+            filled += lastLevel;
+        }
+
+        return distances;
+    }
+
+    // repacks the distances of BuildDistances with 4 bits per entry into 2 bits holding the distance mod 3; the
+    // distances of neighbors differ by at most one, so a search knowing the distance of a state still reads the
+    // exact ones of its neighbors
+    static auto PackDistancesMod3(std::span<const uint8_t> distances, uint32_t size) -> std::vector<uint8_t>;
+
+private:
+    static auto _GetPath(std::string_view name) -> std::filesystem::path;
+    static auto _Load(std::string_view name, uint32_t version, const std::function<std::vector<uint8_t>()>& build) -> Table;
+    static auto _Map(const std::filesystem::path& path, uint32_t version) -> Table;
+    static auto _Write(const std::filesystem::path& path, uint32_t version, std::span<const uint8_t> data) -> bool;
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "ThistlethwaiteSolver.hpp"
+
+#include "StateRank/StateRank.hpp"
+#include "TwoPhaseSolver/TwoPhaseSolver.hpp"
+
+#include <algorithm>
+
+// the slice of every edge position: the M slice (UF, UB, DF, DB), the S slice (UR, UL, DR, DL) and the E slice
+static constexpr std::array<uint8_t, 12> s_EdgeSlices = { 1, 0, 1, 0, 1, 0, 1, 0, 2, 2, 2, 2 };
+
+static auto GetDistance(std::span<const uint8_t> distances, uint32_t index) -> uint8_t
+{
+    return (distances[index >> 1] >> ((index & 1) * 4)) & 0xF;
+}
+static auto GetBinomial(uint32_t n, uint32_t k) -> uint32_t
+{
+    if (k > n)
+        return 0;
+
+    uint32_t binomial = 1;
+    for (uint32_t i = 1; i <= k; i++)
+        binomial = binomial * (n - k + i) / i;
+
+    return binomial;
+}
+
+// the positions of the M slice edges among the U and D layer edges
+static auto GetEdgeClass(const CubieCube& cube) -> uint32_t
+{
+    uint32_t edgeClass = 0, k = 0;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        if (s_EdgeSlices[cube.EdgePermutation[i]] == 0)
+            edgeClass += GetBinomial(i, ++k);
+    }
+
+    return edgeClass;
+}
+// the permutations of the edges within their slices, nullopt if an edge is out of its slice
+static auto GetSliceEdges(const CubieCube& cube) -> std::optional<uint32_t>
+{
+    uint32_t edges = 0;
+    for (uint32_t slice = 0; slice < 3; slice++)
+    {
+        std::array<uint8_t, 4> permutation;
+        for (uint32_t i = 0; i < 4; i++)
+        {
+            uint32_t position = slice == 2 ? 8 + i : 2 * i + 1 - slice;
+            uint8_t edge = cube.EdgePermutation[position];
+            if (s_EdgeSlices[edge] != slice)
+                return std::nullopt;
+
+            permutation[i] = edge < 8 ? edge / 2 : edge - 8;
+        }
+
+        edges = edges * 24 + StateRank::RankPermutation(permutation);
+    }
+
+    return edges;
+}
+
+// the coordinate after each move, from a representative of every coordinate the moves reach from the solved cube
+static auto BuildMoveTable(uint32_t size, std::span<const uint32_t> moves, const auto& getCoordinate) -> std::vector<uint32_t>
+{
+    std::vector<uint32_t> table((size_t)size * CubieCube::MOVE_COUNT, 0);
+    std::vector<bool> seen(size, false);
+    std::vector<CubieCube> representatives = { CubieCube::Solved() };
+    seen[getCoordinate(representatives[0])] = true;
+    for (size_t i = 0; i < representatives.size(); i++)
+    {
+        uint32_t coordinate = getCoordinate(representatives[i]);
+        for (uint32_t move : moves)
+        {
+            CubieCube next = representatives[i];
+            next.ApplyMove(move);
+
+            uint32_t nextCoordinate = getCoordinate(next);
+            table[coordinate * CubieCube::MOVE_COUNT + move] = nextCoordinate;
+            if (!seen[nextCoordinate])
+            {
+                seen[nextCoordinate] = true;
+                representatives.push_back(next);
+            }
+        }
+    }
+
+    return table;
+}
+
+// steps to a neighbor one move closer until the coset is the solved one, false when no neighbor is closer
+static auto Descend(CubieCube& cube, std::vector<uint32_t>& moves, std::span<const uint8_t> distances, std::span<const uint32_t> phaseMoves,
+    const auto& getIndex) -> bool
+{
+    auto getDistance = [&distances, &getIndex](const CubieCube& state) -> std::optional<uint8_t> {
+        std::optional<uint32_t> index = getIndex(state);
+        return index.has_value() ? std::optional<uint8_t>(GetDistance(distances, index.value())) : std::nullopt;
+    };
+
+    std::optional<uint8_t> distance = getDistance(cube);
+    while (distance.has_value() && distance.value() > 0)
+    {
+        std::optional<uint8_t> nextDistance;
+        for (uint32_t move : phaseMoves)
+        {
+            CubieCube next = cube;
+            next.ApplyMove(move);
+
+            nextDistance = getDistance(next);
+            if (nextDistance.has_value() && nextDistance.value() + 1 == distance.value())
+            {
+                cube = next;
+                CubieCube::AppendMove(moves, move);
+                break;
+            }
+        }
+
+        if (!nextDistance.has_value() || nextDistance.value() + 1 != distance.value())
+            return false;
+
+        distance = nextDistance;
+    }
+
+    return distance.has_value();
+}
+
+auto ThistlethwaiteSolver::Solve(const CubieCube& cube) -> std::optional<std::vector<uint32_t>>
+{
+    const Tables& tables = GetTables();
+
+    CubieCube current = cube;
+    std::vector<uint32_t> moves;
+    bool descended =
+        Descend(current, moves, tables.Phase1Distances, s_Phase1Moves, [](const CubieCube& state) { return std::optional(GetPhase1Index(state)); }) &&
+        Descend(current, moves, tables.Phase2Distances, s_Phase2Moves, [](const CubieCube& state) { return std::optional(GetPhase2Index(state)); }) &&
+        Descend(current, moves, tables.Phase3Distances, s_Phase3Moves, [&tables](const CubieCube& state) { return GetPhase3Index(tables, state); }) &&
+        Descend(current, moves, tables.Phase4Distances, s_Phase4Moves, [&tables](const CubieCube& state) { return GetPhase4Index(tables, state); });
+
+    // a single twisted corner or flipped edge only shows at the end, the coordinates leave out the last piece
+    if (!descended || current != CubieCube::Solved())
+        return std::nullopt;
+
+    return moves;
+}
+
+auto ThistlethwaiteSolver::GetTables() -> const Tables&
+{
+    static const Tables tables = _BuildTables();
+    return tables;
+}
+
+auto ThistlethwaiteSolver::GetPhase1Index(const CubieCube& cube) -> uint32_t
+{
+    return TwoPhaseSolver::GetFlip(cube);
+}
+auto ThistlethwaiteSolver::GetPhase2Index(const CubieCube& cube) -> uint32_t
+{
+    return TwoPhaseSolver::GetTwist(cube) * SLICES + TwoPhaseSolver::GetSlice(cube);
+}
+auto ThistlethwaiteSolver::GetPhase3Index(const Tables& tables, const CubieCube& cube) -> std::optional<uint32_t>
+{
+    for (uint32_t i = 8; i < 12; i++)
+    {
+        if (s_EdgeSlices[cube.EdgePermutation[i]] != 2)
+            return std::nullopt;
+    }
+
+    auto corners = std::ranges::lower_bound(tables.CornerClasses, _GetCornerClass(tables, cube.CornerPermutation));
+    return (uint32_t)(corners - tables.CornerClasses.begin()) * EDGE_CLASSES + GetEdgeClass(cube);
+}
+auto ThistlethwaiteSolver::GetPhase4Index(const Tables& tables, const CubieCube& cube) -> std::optional<uint32_t>
+{
+    auto corners = std::ranges::lower_bound(tables.HalfTurnCorners, cube.CornerPermutation);
+    if (corners == tables.HalfTurnCorners.end() || *corners != cube.CornerPermutation)
+        return std::nullopt;
+
+    std::optional<uint32_t> edges = GetSliceEdges(cube);
+    if (!edges.has_value())
+        return std::nullopt;
+
+    return (uint32_t)(corners - tables.HalfTurnCorners.begin()) * SLICE_EDGES + edges.value();
+}
+
+auto ThistlethwaiteSolver::_BuildTables() -> Tables
+{
+    Tables tables;
+
+    // the half turns generate the corner permutations of G3, the corner classes are reached with the G2 moves
+    auto getCorners = [](const std::array<uint8_t, 8>& permutation, uint32_t move) {
+        CubieCube cube = CubieCube::Solved();
+        cube.CornerPermutation = permutation;
+        cube.ApplyMove(move);
+        return cube.CornerPermutation;
+    };
+    tables.HalfTurnCorners = { CubieCube::Solved().CornerPermutation };
+    for (size_t i = 0; i < tables.HalfTurnCorners.size(); i++)
+    {
+        for (uint32_t move : s_Phase4Moves)
+        {
+            std::array<uint8_t, 8> corners = getCorners(tables.HalfTurnCorners[i], move);
+            if (std::ranges::find(tables.HalfTurnCorners, corners) == tables.HalfTurnCorners.end())
+                tables.HalfTurnCorners.push_back(corners);
+        }
+    }
+    std::ranges::sort(tables.HalfTurnCorners);
+
+    tables.CornerClasses = { CubieCube::Solved().CornerPermutation };
+    for (size_t i = 0; i < tables.CornerClasses.size(); i++)
+    {
+        for (uint32_t move : s_Phase3Moves)
+        {
+            std::array<uint8_t, 8> corners = _GetCornerClass(tables, getCorners(tables.CornerClasses[i], move));
+            if (std::ranges::find(tables.CornerClasses, corners) == tables.CornerClasses.end())
+                tables.CornerClasses.push_back(corners);
+        }
+    }
+    std::ranges::sort(tables.CornerClasses);
+
+    auto load = [&tables](std::string_view name, const auto& build) -> std::span<const uint8_t> {
+        return tables.Storage.emplace_back(TableStore::Load(name, TABLE_VERSION, build)).GetBytes();
+    };
+
+    tables.Phase1Distances = load("thistlethwaite_phase1_distances", [] {
+        std::vector<uint32_t> flipMoves = BuildMoveTable(FLIPS, s_Phase1Moves, GetPhase1Index);
+        return TableStore::BuildDistances(FLIPS, 4, GetPhase1Index(CubieCube::Solved()), s_Phase1Moves, [&](uint32_t index, uint32_t move) {
+            return flipMoves[index * CubieCube::MOVE_COUNT + move];
+        });
+    });
+    tables.Phase2Distances = load("thistlethwaite_phase2_distances", [] {
+        std::vector<uint32_t> twistMoves = BuildMoveTable(TWISTS, s_Phase1Moves, TwoPhaseSolver::GetTwist);
+        std::vector<uint32_t> sliceMoves = BuildMoveTable(SLICES, s_Phase1Moves, TwoPhaseSolver::GetSlice);
+        return TableStore::BuildDistances(TWISTS * SLICES, 4, GetPhase2Index(CubieCube::Solved()), s_Phase2Moves, [&](uint32_t index, uint32_t move) {
+            return twistMoves[index / SLICES * CubieCube::MOVE_COUNT + move] * SLICES + sliceMoves[index % SLICES * CubieCube::MOVE_COUNT + move];
+        });
+    });
+    tables.Phase3Distances = load("thistlethwaite_phase3_distances", [&tables] {
+        std::vector<uint32_t> cornerMoves = BuildMoveTable(CORNER_CLASSES, s_Phase3Moves, [&tables](const CubieCube& cube) {
+            return GetPhase3Index(tables, cube).value() / EDGE_CLASSES;
+        });
+        std::vector<uint32_t> edgeMoves = BuildMoveTable(EDGE_CLASSES, s_Phase3Moves, GetEdgeClass);
+        uint32_t solved = GetPhase3Index(tables, CubieCube::Solved()).value();
+        return TableStore::BuildDistances(CORNER_CLASSES * EDGE_CLASSES, 4, solved, s_Phase3Moves, [&](uint32_t index, uint32_t move) {
+            return cornerMoves[index / EDGE_CLASSES * CubieCube::MOVE_COUNT + move] * EDGE_CLASSES + edgeMoves[index % EDGE_CLASSES * CubieCube::MOVE_COUNT + move];
+        });
+    });
+    tables.Phase4Distances = load("thistlethwaite_phase4_distances", [&tables] {
+        std::vector<uint32_t> cornerMoves = BuildMoveTable(HALF_TURN_CORNERS, s_Phase4Moves, [&tables](const CubieCube& cube) {
+            return (uint32_t)(std::ranges::lower_bound(tables.HalfTurnCorners, cube.CornerPermutation) - tables.HalfTurnCorners.begin());
+        });
+        std::vector<uint32_t> edgeMoves = BuildMoveTable(SLICE_EDGES, s_Phase4Moves, [](const CubieCube& cube) { return GetSliceEdges(cube).value(); });
+        // half of the indices have edges of the other parity, which the half turns never reach
+        uint32_t solved = GetPhase4Index(tables, CubieCube::Solved()).value();
+        return TableStore::BuildDistances(HALF_TURN_CORNERS * SLICE_EDGES, 4, solved, s_Phase4Moves, [&](uint32_t index, uint32_t move) {
+            return cornerMoves[index / SLICE_EDGES * CubieCube::MOVE_COUNT + move] * SLICE_EDGES + edgeMoves[index % SLICE_EDGES * CubieCube::MOVE_COUNT + move];
+        });
+    });
+
+    return tables;
+}
+
+auto ThistlethwaiteSolver::_GetCornerClass(const Tables& tables, std::span<const uint8_t> permutation) -> std::array<uint8_t, 8>
+{
+    // a half turn state before the permutation relabels its corners, which keeps the state in its coset of G3
+    std::array<uint8_t, 8> best;
+    std::ranges::fill(best, 0xFF);
+    for (const std::array<uint8_t, 8>& halfTurns : tables.HalfTurnCorners)
+    {
+        std::array<uint8_t, 8> relabeled;
+        for (uint32_t i = 0; i < 8; i++)
+            relabeled[i] = halfTurns[permutation[i]];
+
+        best = std::min(best, relabeled);
+    }
+
+    return best;
+}
@@ -10,6 +10,8 @@ struct Turn
     Direction LayerType;
     uint32_t LayerIndex;
     bool Clockwise;
+
+    auto operator==(const Turn& other) const -> bool = default;
 };
 
 #endif
\ No newline at end of file
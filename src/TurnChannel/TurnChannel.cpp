@@ -0,0 +1,45 @@
+#include "TurnChannel.hpp"
+
+#include <algorithm>
+
+TurnChannel::TurnChannel(size_t capacity)
+    : m_Capacity(std::max<size_t>(capacity, 1)), m_Closed(false) { }
+
+auto TurnChannel::Push(std::span<const Turn> turns, std::stop_token stopToken) -> bool
+{
+    while (!turns.empty())
+    {
+        std::unique_lock lock(m_Mutex);
+        if (!m_Room.wait(lock, stopToken, [this] { return m_Turns.size() < m_Capacity; }))
+            return false;
+
+        size_t count = std::min(turns.size(), m_Capacity - m_Turns.size());
+        m_Turns.insert(m_Turns.end(), turns.begin(), turns.begin() + count);
+        turns = turns.subspan(count);
+    }
+
+    return true;
+}
+auto TurnChannel::Pop() -> std::vector<Turn>
+{
+    std::vector<Turn> turns;
+    {
+        std::lock_guard lock(m_Mutex);
+        turns.assign(m_Turns.begin(), m_Turns.end());
+        m_Turns.clear();
+    }
+
+    m_Room.notify_all();
+    return turns;
+}
+
+auto TurnChannel::Close() -> void
+{
+    std::lock_guard lock(m_Mutex);
+    m_Closed = true;
+}
+auto TurnChannel::IsDrained() const -> bool
+{
+    std::lock_guard lock(m_Mutex);
+    return m_Closed && m_Turns.empty();
+}
@@ -0,0 +1,40 @@
+#ifndef TURNCHANNEL_H
+#define TURNCHANNEL_H
+
+#include "Turn/Turn.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+// A bounded queue of turns from a producer thread to a consumer thread. The producer waits while it is full,
+// so a solver never runs further ahead of the animations than the capacity.
+class TurnChannel
+{
+public:
+    explicit TurnChannel(size_t capacity);
+
+    // waits for room as needed, false if the stop was requested before all the turns were in
+    auto Push(std::span<const Turn> turns, std::stop_token stopToken) -> bool;
+    // every turn queued so far, without waiting
+    auto Pop() -> std::vector<Turn>;
+
+    // no more turns will be pushed
+    auto Close() -> void;
+    // closed and empty
+    auto IsDrained() const -> bool;
+
+private:
+    size_t m_Capacity;
+
+    mutable std::mutex m_Mutex;
+    std::condition_variable_any m_Room;
+    std::deque<Turn> m_Turns;
+    bool m_Closed;
+};
+
+#endif
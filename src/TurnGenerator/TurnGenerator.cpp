@@ -0,0 +1,41 @@
+#include "TurnGenerator.hpp"
+
+#include <utility>
+
+TurnGenerator::TurnGenerator(std::coroutine_handle<promise_type> handle)
+    : m_Handle(handle) { }
+TurnGenerator::~TurnGenerator()
+{
+    if (m_Handle)
+        m_Handle.destroy();
+}
+
+TurnGenerator::TurnGenerator(TurnGenerator&& other) noexcept
+    : m_Handle(std::exchange(other.m_Handle, nullptr)) { }
+auto TurnGenerator::operator=(TurnGenerator&& other) noexcept -> TurnGenerator&
+{
+    if (this != &other)
+    {
+        if (m_Handle)
+            m_Handle.destroy();
+
+        m_Handle = std::exchange(other.m_Handle, nullptr);
+    }
+
+    return *this;
+}
+
+auto TurnGenerator::Next() -> std::optional<std::vector<Turn>>
+{
+    while (!m_Handle.done())
+    {
+        m_Handle.resume();
+        if (m_Handle.done())
+            break;
+
+        if (!m_Handle.promise().Batch.empty())
+            return std::move(m_Handle.promise().Batch);
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,51 @@
+#ifndef TURNGENERATOR_H
+#define TURNGENERATOR_H
+
+#include "Turn/Turn.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <vector>
+
+// A coroutine yielding the turns of a solve in batches, each one as soon as it is decided, and returning
+// whether the solve succeeded. The coroutine only runs inside Next, on the calling thread.
+class TurnGenerator
+{
+public:
+    struct promise_type
+    {
+        std::vector<Turn> Batch;
+        bool Solved = false;
+
+        inline auto get_return_object() -> TurnGenerator { return TurnGenerator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        inline auto initial_suspend() -> std::suspend_always { return { }; }
+        inline auto final_suspend() noexcept -> std::suspend_always { return { }; }
+        inline auto yield_value(std::vector<Turn> batch) -> std::suspend_always
+        {
+            Batch = std::move(batch);
+            return { };
+        }
+        inline auto return_value(bool solved) -> void { Solved = solved; }
+        inline auto unhandled_exception() -> void { std::terminate(); }
+    };
+
+public:
+    explicit TurnGenerator(std::coroutine_handle<promise_type> handle);
+    ~TurnGenerator();
+
+    TurnGenerator(TurnGenerator&& other) noexcept;
+    auto operator=(TurnGenerator&& other) noexcept -> TurnGenerator&;
+    TurnGenerator(const TurnGenerator&) = delete;
+    auto operator=(const TurnGenerator&) -> TurnGenerator& = delete;
+
+    // runs the coroutine to its next non-empty batch, nullopt once it has returned
+    auto Next() -> std::optional<std::vector<Turn>>;
+    // only meaningful once Next returned nullopt
+    inline auto IsSolved() const -> bool { return m_Handle.promise().Solved; }
+
+private:
+    std::coroutine_handle<promise_type> m_Handle;
+};
+
+#endif
@@ -0,0 +1,421 @@
+#include "TwoPhaseSolver.hpp"
+
+#include "StateRank/StateRank.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+using enum CubieCube::Edge;
+
+static constexpr auto s_Binomials = [] {
+    std::array<std::array<uint32_t, 13>, 13> binomials { };
+    for (uint32_t n = 0; n < 13; n++)
+    {
+        binomials[n][0] = 1;
+        for (uint32_t k = 1; k <= n; k++)
+            binomials[n][k] = binomials[n - 1][k - 1] + binomials[n - 1][k];
+    }
+
+    return binomials;
+}();
+
+static auto IsPhase2Move(uint32_t move) -> bool
+{
+    return std::ranges::find(TwoPhaseSolver::s_Phase2Moves, move) != TwoPhaseSolver::s_Phase2Moves.end();
+}
+
+// a move on the face of the previous one or on its opposite face when that one came first adds nothing
+static auto IsRedundantMove(uint32_t move, uint32_t previousMove) -> bool
+{
+    uint32_t face = move / 3;
+    uint32_t previousFace = previousMove / 3;
+    return face == previousFace || face + 3 == previousFace;
+}
+
+static auto SetTwist(uint32_t twist) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+    StateRank::UnrankTwist(twist, cube.CornerOrientation);
+    return cube;
+}
+static auto SetFlip(uint32_t flip) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+    StateRank::UnrankFlip(flip, cube.EdgeOrientation);
+    return cube;
+}
+static auto SetSlice(uint32_t slice) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+
+    // the positions of the slice edges in the combinatorial number system, largest first
+    std::array<bool, 12> occupied { };
+    for (uint32_t k = 4; k > 0; k--)
+    {
+        uint32_t position = k - 1;
+        while (position + 1 < 12 && s_Binomials[position + 1][k] <= slice)
+            position++;
+
+        slice -= s_Binomials[position][k];
+        occupied[position] = true;
+    }
+
+    uint8_t sliceEdge = FR, otherEdge = UR;
+    for (uint32_t i = 0; i < 12; i++)
+        cube.EdgePermutation[i] = occupied[i] ? sliceEdge++ : otherEdge++;
+
+    return cube;
+}
+static auto SetCornerPermutation(uint32_t permutation) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+    StateRank::UnrankPermutation(permutation, cube.CornerPermutation);
+    return cube;
+}
+static auto SetEdgePermutation(uint32_t permutation) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+    StateRank::UnrankPermutation(permutation, std::span(cube.EdgePermutation).first(8));
+    return cube;
+}
+static auto SetSlicePermutation(uint32_t permutation) -> CubieCube
+{
+    CubieCube cube = CubieCube::Solved();
+    StateRank::UnrankPermutation(permutation, std::span(cube.EdgePermutation).last(4));
+    for (uint32_t i = 8; i < 12; i++)
+        cube.EdgePermutation[i] += FR;
+
+    return cube;
+}
+
+static auto BuildMoveTable(
+    uint32_t size,
+    const std::function<CubieCube(uint32_t)>& setCoordinate,
+    const std::function<uint32_t(const CubieCube&)>& getCoordinate,
+    std::span<const uint32_t> moves
+) -> std::vector<uint16_t>
+{
+    std::vector<uint16_t> table(size * CubieCube::MOVE_COUNT, 0);
+    for (uint32_t coordinate = 0; coordinate < size; coordinate++)
+    {
+        CubieCube cube = setCoordinate(coordinate);
+        for (uint32_t move : moves)
+        {
+            CubieCube turned = cube;
+            turned.Multiply(CubieCube::GetMove(move));
+            table[coordinate * CubieCube::MOVE_COUNT + move] = getCoordinate(turned);
+        }
+    }
+
+    return table;
+}
+
+// the distances over the product of two coordinates
+static auto BuildPruningTable(
+    uint32_t size1, std::span<const uint16_t> moves1, uint32_t solved1,
+    uint32_t size2, std::span<const uint16_t> moves2, uint32_t solved2,
+    std::span<const uint32_t> moves
+) -> std::vector<uint8_t>
+{
+    return TableStore::BuildDistances(size1 * size2, 8, solved1 * size2 + solved2, moves, [&](uint32_t index, uint32_t move) {
+        return moves1[index / size2 * CubieCube::MOVE_COUNT + move] * size2 + moves2[index % size2 * CubieCube::MOVE_COUNT + move];
+    });
+}
+
+// the state of one solve: the move stack shared by both phases and the best solution so far
+struct TwoPhaseSearch
+{
+    const TwoPhaseSolver::Tables& Tables;
+    CubieCube Cube;
+    uint32_t MaxLength;
+    std::chrono::steady_clock::time_point Deadline;
+
+    std::array<uint32_t, 32> Moves;
+    std::optional<std::vector<uint32_t>> Best;
+    uint64_t Nodes = 0;
+
+    // a hard deadline or the stop ends the search even before the first solution, they are checked in both phases
+    bool HardDeadline = false;
+    std::stop_token StopToken = { };
+    const std::function<void(std::span<const uint32_t>)>* Improved = nullptr;
+    bool Expired = false;
+
+    auto IsDone() -> bool
+    {
+        if (Expired)
+            return true;
+
+        if (StopToken.stop_requested() || (HardDeadline && std::chrono::steady_clock::now() >= Deadline))
+        {
+            Expired = true;
+            return true;
+        }
+
+        if (!Best.has_value())
+            return false;
+
+        return Best->size() <= MaxLength || std::chrono::steady_clock::now() >= Deadline;
+    }
+
+    auto Phase1(uint32_t twist, uint32_t flip, uint32_t slice, uint32_t depth, uint32_t togo) -> bool
+    {
+        if (togo == 0)
+        {
+            // a phase 1 solution ending with a phase 2 move is found again one move shorter
+            if (depth > 0 && IsPhase2Move(Moves[depth - 1]))
+                return false;
+
+            return StartPhase2(depth);
+        }
+
+        if (++Nodes % 1024 == 0 && IsDone())
+            return true;
+
+        for (uint32_t move = 0; move < CubieCube::MOVE_COUNT; move++)
+        {
+            if (depth > 0 && IsRedundantMove(move, Moves[depth - 1]))
+                continue;
+
+            uint32_t nextTwist = Tables.TwistMoves[twist * CubieCube::MOVE_COUNT + move];
+            uint32_t nextFlip = Tables.FlipMoves[flip * CubieCube::MOVE_COUNT + move];
+            uint32_t nextSlice = Tables.SliceMoves[slice * CubieCube::MOVE_COUNT + move];
+
+            uint32_t distance = std::max(
+                Tables.SliceTwistDistances[nextSlice * TwoPhaseSolver::TWISTS + nextTwist],
+                Tables.SliceFlipDistances[nextSlice * TwoPhaseSolver::FLIPS + nextFlip]
+            );
+            if (distance >= togo)
+                continue;
+
+            Moves[depth] = move;
+            if (Phase1(nextTwist, nextFlip, nextSlice, depth + 1, togo - 1))
+                return true;
+        }
+
+        return false;
+    }
+
+    auto StartPhase2(uint32_t phase1Length) -> bool
+    {
+        CubieCube cube = Cube;
+        for (uint32_t i = 0; i < phase1Length; i++)
+            cube.ApplyMove(Moves[i]);
+
+        uint32_t cornerPermutation = TwoPhaseSolver::GetCornerPermutation(cube);
+        uint32_t edgePermutation = TwoPhaseSolver::GetEdgePermutation(cube);
+        uint32_t slicePermutation = TwoPhaseSolver::GetSlicePermutation(cube);
+
+        // only solutions shorter than the best one so far are of interest
+        uint32_t maxPhase2Length = TwoPhaseSolver::MAX_PHASE2_LENGTH;
+        if (Best.has_value())
+        {
+            if (Best->size() <= phase1Length + 1)
+                return false;
+
+            maxPhase2Length = std::min<uint32_t>(maxPhase2Length, Best->size() - 1 - phase1Length);
+        }
+
+        uint32_t distance = std::max(
+            Tables.SliceCornerDistances[slicePermutation * TwoPhaseSolver::CORNER_PERMUTATIONS + cornerPermutation],
+            Tables.SliceEdgeDistances[slicePermutation * TwoPhaseSolver::EDGE_PERMUTATIONS + edgePermutation]
+        );
+        for (uint32_t length = distance; length <= maxPhase2Length && !Expired; length++)
+        {
+            if (Phase2(cornerPermutation, edgePermutation, slicePermutation, phase1Length, length))
+            {
+                Best = std::vector<uint32_t>(Moves.begin(), Moves.begin() + phase1Length + length);
+                if (Improved != nullptr && *Improved)
+                    (*Improved)(Best.value());
+
+                break;
+            }
+        }
+
+        return IsDone();
+    }
+
+    auto Phase2(uint32_t cornerPermutation, uint32_t edgePermutation, uint32_t slicePermutation, uint32_t depth, uint32_t togo) -> bool
+    {
+        if (togo == 0)
+            return cornerPermutation == 0 && edgePermutation == 0 && slicePermutation == 0;
+
+        if (++Nodes % 1024 == 0 && (HardDeadline || StopToken.stop_requested()) && IsDone())
+            return false;
+        if (Expired)
+            return false;
+        for (uint32_t move : TwoPhaseSolver::s_Phase2Moves)
+        {
+            if (depth > 0 && IsRedundantMove(move, Moves[depth - 1]))
+                continue;
+
+            uint32_t nextCornerPermutation = Tables.CornerPermutationMoves[cornerPermutation * CubieCube::MOVE_COUNT + move];
+            uint32_t nextEdgePermutation = Tables.EdgePermutationMoves[edgePermutation * CubieCube::MOVE_COUNT + move];
+            uint32_t nextSlicePermutation = Tables.SlicePermutationMoves[slicePermutation * CubieCube::MOVE_COUNT + move];
+
+            uint32_t distance = std::max(
+                Tables.SliceCornerDistances[nextSlicePermutation * TwoPhaseSolver::CORNER_PERMUTATIONS + nextCornerPermutation],
+                Tables.SliceEdgeDistances[nextSlicePermutation * TwoPhaseSolver::EDGE_PERMUTATIONS + nextEdgePermutation]
+            );
+            if (distance >= togo)
+                continue;
+
+            Moves[depth] = move;
+            if (Phase2(nextCornerPermutation, nextEdgePermutation, nextSlicePermutation, depth + 1, togo - 1))
+                return true;
+        }
+
+        return false;
+    }
+};
+
+auto TwoPhaseSolver::Solve(const CubieCube& cube, uint32_t maxLength, std::chrono::milliseconds timeout, std::stop_token stopToken)
+    -> std::optional<std::vector<uint32_t>>
+{
+    if (!_IsSolvable(cube))
+        return std::nullopt;
+
+    TwoPhaseSearch search {
+        .Tables = GetTables(),
+        .Cube = cube,
+        .MaxLength = maxLength,
+        .Deadline = std::chrono::steady_clock::now() + timeout,
+        .Moves = { },
+        .Best = std::nullopt,
+        .StopToken = stopToken
+    };
+
+    return _Search(search);
+}
+auto TwoPhaseSolver::Improve(const CubieCube& cube, std::chrono::steady_clock::time_point deadline, std::stop_token stopToken,
+    const std::function<void(std::span<const uint32_t>)>& improved) -> std::optional<std::vector<uint32_t>>
+{
+    if (!_IsSolvable(cube))
+        return std::nullopt;
+
+    TwoPhaseSearch search {
+        .Tables = GetTables(),
+        .Cube = cube,
+        .MaxLength = 0,
+        .Deadline = deadline,
+        .Moves = { },
+        .Best = std::nullopt,
+        .HardDeadline = true,
+        .StopToken = stopToken,
+        .Improved = &improved
+    };
+
+    return _Search(search);
+}
+
+auto TwoPhaseSolver::GetTables() -> const Tables&
+{
+    static const Tables tables = _BuildTables();
+    return tables;
+}
+
+auto TwoPhaseSolver::_IsSolvable(const CubieCube& cube) -> bool
+{
+    // every corner and edge must appear once, with consistent twists, flips and parities
+    std::array<uint8_t, 8> corners = cube.CornerPermutation;
+    std::array<uint8_t, 12> edges = cube.EdgePermutation;
+    std::ranges::sort(corners);
+    std::ranges::sort(edges);
+    bool permutations = std::ranges::equal(corners, CubieCube::Solved().CornerPermutation) && std::ranges::equal(edges, CubieCube::Solved().EdgePermutation);
+    bool orientations = std::reduce(cube.CornerOrientation.begin(), cube.CornerOrientation.end(), 0u) % 3 == 0 &&
+        std::reduce(cube.EdgeOrientation.begin(), cube.EdgeOrientation.end(), 0u) % 2 == 0 &&
+        std::ranges::all_of(cube.CornerOrientation, [](uint8_t orientation) { return orientation < 3; });
+
+    return permutations && orientations && cube.GetCornerParity() == cube.GetEdgeParity();
+}
+auto TwoPhaseSolver::_Search(TwoPhaseSearch& search) -> std::optional<std::vector<uint32_t>>
+{
+    uint32_t twist = GetTwist(search.Cube), flip = GetFlip(search.Cube), slice = GetSlice(search.Cube);
+    uint32_t distance = std::max(
+        search.Tables.SliceTwistDistances[slice * TWISTS + twist],
+        search.Tables.SliceFlipDistances[slice * FLIPS + flip]
+    );
+    for (uint32_t length = distance; length < search.Moves.size() - MAX_PHASE2_LENGTH; length++)
+    {
+        if (search.Best.has_value() && search.Best->size() <= length)
+            break;
+
+        if (search.Phase1(twist, flip, slice, 0, length))
+            break;
+    }
+
+    return search.Best;
+}
+
+auto TwoPhaseSolver::GetTwist(const CubieCube& cube) -> uint32_t
+{
+    return StateRank::RankTwist(cube.CornerOrientation);
+}
+auto TwoPhaseSolver::GetFlip(const CubieCube& cube) -> uint32_t
+{
+    return StateRank::RankFlip(cube.EdgeOrientation);
+}
+auto TwoPhaseSolver::GetSlice(const CubieCube& cube) -> uint32_t
+{
+    uint32_t slice = 0, k = 0;
+    for (uint32_t i = 0; i < 12; i++)
+        if (cube.EdgePermutation[i] >= FR)
+            slice += s_Binomials[i][++k];
+
+    return slice;
+}
+auto TwoPhaseSolver::GetCornerPermutation(const CubieCube& cube) -> uint32_t
+{
+    return StateRank::RankPermutation(cube.CornerPermutation);
+}
+auto TwoPhaseSolver::GetEdgePermutation(const CubieCube& cube) -> uint32_t
+{
+    return StateRank::RankPermutation(std::span(cube.EdgePermutation).first(8));
+}
+auto TwoPhaseSolver::GetSlicePermutation(const CubieCube& cube) -> uint32_t
+{
+    std::array<uint8_t, 4> permutation;
+    for (uint32_t i = 0; i < 4; i++)
+        permutation[i] = cube.EdgePermutation[8 + i] - FR;
+
+    return StateRank::RankPermutation(permutation);
+}
+
+auto TwoPhaseSolver::_BuildTables() -> Tables
+{
+    std::array<uint32_t, CubieCube::MOVE_COUNT> allMoves;
+    std::iota(allMoves.begin(), allMoves.end(), 0);
+
+    Tables tables;
+    auto load = [&tables](std::string_view name, const auto& build) -> const TableStore::Table& {
+        return tables.Storage.emplace_back(TableStore::Load(name, TABLE_VERSION, build));
+    };
+
+    tables.TwistMoves = load("twophase_twist_moves", [&] { return BuildMoveTable(TWISTS, SetTwist, GetTwist, allMoves); }).As<uint16_t>();
+    tables.FlipMoves = load("twophase_flip_moves", [&] { return BuildMoveTable(FLIPS, SetFlip, GetFlip, allMoves); }).As<uint16_t>();
+    tables.SliceMoves = load("twophase_slice_moves", [&] { return BuildMoveTable(SLICES, SetSlice, GetSlice, allMoves); }).As<uint16_t>();
+    tables.CornerPermutationMoves = load("twophase_corner_permutation_moves", [&] {
+        return BuildMoveTable(CORNER_PERMUTATIONS, SetCornerPermutation, GetCornerPermutation, allMoves);
+    }).As<uint16_t>();
+    tables.EdgePermutationMoves = load("twophase_edge_permutation_moves", [&] {
+        return BuildMoveTable(EDGE_PERMUTATIONS, SetEdgePermutation, GetEdgePermutation, s_Phase2Moves);
+    }).As<uint16_t>();
+    tables.SlicePermutationMoves = load("twophase_slice_permutation_moves", [&] {
+        return BuildMoveTable(SLICE_PERMUTATIONS, SetSlicePermutation, GetSlicePermutation, s_Phase2Moves);
+    }).As<uint16_t>();
+
+    tables.SliceTwistDistances = load("twophase_slice_twist_distances", [&] {
+        return BuildPruningTable(SLICES, tables.SliceMoves, SOLVED_SLICE, TWISTS, tables.TwistMoves, 0, allMoves);
+    }).GetBytes();
+    tables.SliceFlipDistances = load("twophase_slice_flip_distances", [&] {
+        return BuildPruningTable(SLICES, tables.SliceMoves, SOLVED_SLICE, FLIPS, tables.FlipMoves, 0, allMoves);
+    }).GetBytes();
+    tables.SliceCornerDistances = load("twophase_slice_corner_distances", [&] {
+        return BuildPruningTable(SLICE_PERMUTATIONS, tables.SlicePermutationMoves, 0, CORNER_PERMUTATIONS, tables.CornerPermutationMoves, 0, s_Phase2Moves);
+    }).GetBytes();
+    tables.SliceEdgeDistances = load("twophase_slice_edge_distances", [&] {
+        return BuildPruningTable(SLICE_PERMUTATIONS, tables.SlicePermutationMoves, 0, EDGE_PERMUTATIONS, tables.EdgePermutationMoves, 0, s_Phase2Moves);
+    }).GetBytes();
+
+    return tables;
+}
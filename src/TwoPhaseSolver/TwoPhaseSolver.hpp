@@ -0,0 +1,86 @@
+#ifndef TWOPHASESOLVER_H
+#define TWOPHASESOLVER_H
+
+#include "CubieCube/CubieCube.hpp"
+#include "TableStore/TableStore.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+// Kociemba's two-phase algorithm: phase 1 brings the cube into <U, D, R2, L2, F2, B2> (no twisted corners,
+// no flipped edges, the slice edges in the slice), phase 2 solves it with these moves only. Both phases are
+// IDA* searches over coordinates with move tables and pruning tables, which are built on first use.
+struct TwoPhaseSearch;
+
+class TwoPhaseSolver
+{
+public:
+    static constexpr uint32_t TWISTS = 2187;
+    static constexpr uint32_t FLIPS = 2048;
+    static constexpr uint32_t SLICES = 495;
+    static constexpr uint32_t CORNER_PERMUTATIONS = 40320;
+    static constexpr uint32_t EDGE_PERMUTATIONS = 40320;
+    static constexpr uint32_t SLICE_PERMUTATIONS = 24;
+
+    static constexpr uint32_t SOLVED_SLICE = 494;
+    static constexpr uint32_t MAX_PHASE2_LENGTH = 18;
+    // what Solve is content with, and how long it searches for it
+    static constexpr uint32_t DEFAULT_LENGTH = 22;
+    static constexpr std::chrono::milliseconds DEFAULT_TIMEOUT = std::chrono::milliseconds(1000);
+
+    // the phase 2 moves U, U2, U', D, D2, D', R2, L2, F2, B2
+    static constexpr std::array<uint32_t, 10> s_Phase2Moves = { 0, 1, 2, 9, 10, 11, 4, 13, 7, 16 };
+
+    static constexpr uint32_t TABLE_VERSION = 1;
+
+    struct Tables
+    {
+        std::span<const uint16_t> TwistMoves;
+        std::span<const uint16_t> FlipMoves;
+        std::span<const uint16_t> SliceMoves;
+        std::span<const uint16_t> CornerPermutationMoves;
+        std::span<const uint16_t> EdgePermutationMoves;
+        std::span<const uint16_t> SlicePermutationMoves;
+
+        std::span<const uint8_t> SliceTwistDistances;
+        std::span<const uint8_t> SliceFlipDistances;
+        std::span<const uint8_t> SliceCornerDistances;
+        std::span<const uint8_t> SliceEdgeDistances;
+
+        // the stored tables the spans point into
+        std::vector<TableStore::Table> Storage;
+    };
+
+public:
+    // searches until a solution of at most maxLength moves is found, or returns the shortest one found
+    // before the timeout or the stop; nullopt for unsolvable cubes and when stopped before the first solution
+    static auto Solve(const CubieCube& cube, uint32_t maxLength = DEFAULT_LENGTH, std::chrono::milliseconds timeout = DEFAULT_TIMEOUT,
+        std::stop_token stopToken = { }) -> std::optional<std::vector<uint32_t>>;
+    // keeps searching shorter solutions until the deadline or the stop, passing each one to improved as it is
+    // found, and returns within a millisecond of the deadline; nullopt if there was none by then
+    static auto Improve(const CubieCube& cube, std::chrono::steady_clock::time_point deadline, std::stop_token stopToken,
+        const std::function<void(std::span<const uint32_t>)>& improved) -> std::optional<std::vector<uint32_t>>;
+
+    static auto GetTables() -> const Tables&;
+
+    static auto GetTwist(const CubieCube& cube) -> uint32_t;
+    static auto GetFlip(const CubieCube& cube) -> uint32_t;
+    static auto GetSlice(const CubieCube& cube) -> uint32_t;
+    static auto GetCornerPermutation(const CubieCube& cube) -> uint32_t;
+    // the permutation of the U and D layer edges and of the slice edges, only meaningful in phase 2
+    static auto GetEdgePermutation(const CubieCube& cube) -> uint32_t;
+    static auto GetSlicePermutation(const CubieCube& cube) -> uint32_t;
+
+private:
+    static auto _BuildTables() -> Tables;
+    static auto _IsSolvable(const CubieCube& cube) -> bool;
+    static auto _Search(TwoPhaseSearch& search) -> std::optional<std::vector<uint32_t>>;
+};
+
+#endif